@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+struct bench_array {
+	uint64_t *keys;
+	size_t first;
+	size_t len;
+};
+
+static void *bench_array_create(size_t capacity)
+{
+	struct bench_array *set;
+
+	set = (struct bench_array *)malloc(sizeof(*set));
+	if (!set)
+		abort();
+
+	set->keys = (uint64_t *)malloc((capacity + 1) * sizeof(*set->keys));
+	if (!set->keys)
+		abort();
+
+	set->first = 0;
+	set->len = 0;
+
+	return set;
+}
+
+static void bench_array_destroy(void *ctx)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+
+	free(set->keys);
+	free(set);
+}
+
+static size_t bench_array_lower_bound(const struct bench_array *set,
+				      uint64_t key)
+{
+	size_t low = set->first;
+	size_t high = set->first + set->len;
+	size_t mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+
+		if (set->keys[mid] < key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+static void bench_array_insert(void *ctx, uint64_t key)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+	size_t pos;
+
+	/* make room at the end after pop_min moved the start */
+	if (set->first) {
+		memmove(&set->keys[0], &set->keys[set->first],
+			set->len * sizeof(*set->keys));
+		set->first = 0;
+	}
+
+	pos = bench_array_lower_bound(set, key);
+	memmove(&set->keys[pos + 1], &set->keys[pos],
+		(set->len - pos) * sizeof(*set->keys));
+	set->keys[pos] = key;
+	set->len++;
+}
+
+static bool bench_array_find(void *ctx, uint64_t key)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+	size_t pos;
+
+	pos = bench_array_lower_bound(set, key);
+
+	return pos < set->first + set->len && set->keys[pos] == key;
+}
+
+static bool bench_array_erase(void *ctx, uint64_t key)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+	size_t end = set->first + set->len;
+	size_t pos;
+
+	pos = bench_array_lower_bound(set, key);
+	if (pos >= end || set->keys[pos] != key)
+		return false;
+
+	memmove(&set->keys[pos], &set->keys[pos + 1],
+		(end - pos - 1) * sizeof(*set->keys));
+	set->len--;
+
+	return true;
+}
+
+static bool bench_array_pop_min(void *ctx, uint64_t *key)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+
+	if (!set->len)
+		return false;
+
+	*key = set->keys[set->first];
+	set->first++;
+	set->len--;
+
+	return true;
+}
+
+static uint64_t bench_array_range(void *ctx, uint64_t from, size_t count)
+{
+	struct bench_array *set = (struct bench_array *)ctx;
+	size_t end = set->first + set->len;
+	uint64_t sum = 0;
+	size_t pos;
+
+	pos = bench_array_lower_bound(set, from);
+	for (; pos < end && count; pos++, count--)
+		sum += set->keys[pos];
+
+	return sum;
+}
+
+const struct bench_backend bench_backend_array = {
+	"array",
+	128 * 1024,
+	bench_array_create,
+	bench_array_destroy,
+	bench_array_insert,
+	bench_array_find,
+	bench_array_erase,
+	bench_array_pop_min,
+	bench_array_range,
+	NULL,
+};
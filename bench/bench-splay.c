@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../splaypool.h"
+#include "../splaytree.h"
+#include "bench.h"
+
+struct bench_splay_item {
+	uint64_t key;
+	struct splay_node splay;
+};
+
+struct bench_splay {
+	struct splay_root root;
+	struct splay_pool pool;
+};
+
+static void *bench_splay_create(size_t capacity)
+{
+	struct bench_splay *set;
+
+	(void)capacity;
+
+	set = (struct bench_splay *)malloc(sizeof(*set));
+	if (!set)
+		abort();
+
+	INIT_SPLAY_ROOT(&set->root);
+	splay_pool_init(&set->pool, sizeof(struct bench_splay_item), 0, 0);
+
+	return set;
+}
+
+static void bench_splay_destroy(void *ctx)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+
+	splay_pool_free_all(&set->pool);
+	free(set);
+}
+
+static void bench_splay_insert(void *ctx, uint64_t key)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct splay_node **cur_nodep = &set->root.node;
+	struct splay_node *parent = NULL;
+	struct bench_splay_item *cur_entry;
+	struct bench_splay_item *item;
+
+	item = (struct bench_splay_item *)splay_pool_alloc(&set->pool);
+	if (!item)
+		abort();
+
+	item->key = key;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct bench_splay_item,
+					splay);
+
+		parent = *cur_nodep;
+		if (key <= cur_entry->key)
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+	}
+
+	splay_insert(&item->splay, parent, cur_nodep, &set->root);
+}
+
+/**
+ * bench_splay_lower_bound() - Search first key not smaller than @key
+ * @set: splay tree set
+ * @key: key to search
+ *
+ * The last visited node is splayed to the root - even when nothing was
+ * found. Otherwise repeated unsuccessful searches would not adjust the tree.
+ *
+ * Return: first entry not smaller than @key, NULL if no such entry exists
+ */
+static struct bench_splay_item *bench_splay_lower_bound(struct bench_splay *set,
+							 uint64_t key)
+{
+	struct splay_node *node = set->root.node;
+	struct bench_splay_item *found = NULL;
+	struct bench_splay_item *cur_entry;
+	struct splay_node *last = NULL;
+
+	while (node) {
+		cur_entry = splay_entry(node, struct bench_splay_item, splay);
+		last = node;
+
+		if (key <= cur_entry->key) {
+			found = cur_entry;
+			node = node->left;
+		} else {
+			node = node->right;
+		}
+	}
+
+	if (found)
+		splay_splaying(&found->splay, &set->root);
+	else if (last)
+		splay_splaying(last, &set->root);
+
+	return found;
+}
+
+static bool bench_splay_find(void *ctx, uint64_t key)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct bench_splay_item *item;
+
+	item = bench_splay_lower_bound(set, key);
+
+	return item && item->key == key;
+}
+
+static bool bench_splay_erase(void *ctx, uint64_t key)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct bench_splay_item *item;
+
+	item = bench_splay_lower_bound(set, key);
+	if (!item || item->key != key)
+		return false;
+
+	splay_erase(&item->splay, &set->root);
+	splay_pool_free(&set->pool, item);
+
+	return true;
+}
+
+static bool bench_splay_pop_min(void *ctx, uint64_t *key)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct bench_splay_item *item;
+	struct splay_node *node;
+
+	node = splay_first(&set->root);
+	if (!node)
+		return false;
+
+	item = splay_entry(node, struct bench_splay_item, splay);
+	*key = item->key;
+
+	splay_erase(node, &set->root);
+	splay_pool_free(&set->pool, item);
+
+	return true;
+}
+
+static uint64_t bench_splay_range(void *ctx, uint64_t from, size_t count)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct bench_splay_item *item;
+	struct splay_node *node;
+	uint64_t sum = 0;
+
+	item = bench_splay_lower_bound(set, from);
+	if (!item)
+		return sum;
+
+	for (node = &item->splay; node && count; node = splay_next(node)) {
+		item = splay_entry(node, struct bench_splay_item, splay);
+		sum += item->key;
+		count--;
+	}
+
+	return sum;
+}
+
+#ifdef SPLAYTREE_STATS
+static uint64_t bench_splay_rotations(void *ctx)
+{
+	struct bench_splay *set = (struct bench_splay *)ctx;
+	struct splay_stats stats;
+
+	splay_stats_snapshot(&set->root, &stats);
+
+	return stats.zig + 2 * (stats.zigzig + stats.zigzag);
+}
+#endif
+
+const struct bench_backend bench_backend_splay = {
+	"splay",
+	0,
+	bench_splay_create,
+	bench_splay_destroy,
+	bench_splay_insert,
+	bench_splay_find,
+	bench_splay_erase,
+	bench_splay_pop_min,
+	bench_splay_range,
+#ifdef SPLAYTREE_STATS
+	bench_splay_rotations,
+#else
+	NULL,
+#endif
+};
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../splaypool.h"
+#include "../splaytree.h"
+#include "bench.h"
+
+struct bench_splaydir_item {
+	uint64_t key;
+	struct splay_dir_node splay;
+};
+
+struct bench_splaydir {
+	struct splay_dir_root root;
+	struct splay_pool pool;
+};
+
+static void *bench_splaydir_create(size_t capacity)
+{
+	struct bench_splaydir *set;
+
+	(void)capacity;
+
+	set = (struct bench_splaydir *)malloc(sizeof(*set));
+	if (!set)
+		abort();
+
+	INIT_SPLAY_DIR_ROOT(&set->root);
+	splay_pool_init(&set->pool, sizeof(struct bench_splaydir_item), 0, 0);
+
+	return set;
+}
+
+static void bench_splaydir_destroy(void *ctx)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+
+	splay_pool_free_all(&set->pool);
+	free(set);
+}
+
+static void bench_splaydir_insert(void *ctx, uint64_t key)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct splay_dir_node **cur_nodep = &set->root.node;
+	struct splay_dir_node *parent = NULL;
+	struct bench_splaydir_item *cur_entry;
+	struct bench_splaydir_item *item;
+
+	item = (struct bench_splaydir_item *)splay_pool_alloc(&set->pool);
+	if (!item)
+		abort();
+
+	item->key = key;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct bench_splaydir_item,
+					splay);
+
+		parent = *cur_nodep;
+		cur_nodep = &((*cur_nodep)->child[key > cur_entry->key]);
+	}
+
+	splay_dir_insert(&item->splay, parent, cur_nodep, &set->root);
+}
+
+/**
+ * bench_splaydir_lower_bound() - Search first key not smaller than @key
+ * @set: splay tree set
+ * @key: key to search
+ *
+ * The last visited node is splayed to the root - even when nothing was
+ * found. Otherwise repeated unsuccessful searches would not adjust the tree.
+ *
+ * The side of the descent is used as index for the child array. The compiler
+ * can therefore use conditional moves instead of a branch on the comparison.
+ *
+ * Return: first entry not smaller than @key, NULL if no such entry exists
+ */
+static struct bench_splaydir_item *
+bench_splaydir_lower_bound(struct bench_splaydir *set, uint64_t key)
+{
+	struct splay_dir_node *node = set->root.node;
+	struct bench_splaydir_item *found = NULL;
+	struct bench_splaydir_item *cur_entry;
+	struct splay_dir_node *last = NULL;
+	unsigned int dir;
+
+	while (node) {
+		cur_entry = splay_entry(node, struct bench_splaydir_item,
+					splay);
+		last = node;
+
+		dir = key > cur_entry->key;
+		found = dir ? found : cur_entry;
+		node = node->child[dir];
+	}
+
+	if (found)
+		splay_dir_splaying(&found->splay, &set->root);
+	else if (last)
+		splay_dir_splaying(last, &set->root);
+
+	return found;
+}
+
+static bool bench_splaydir_find(void *ctx, uint64_t key)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct bench_splaydir_item *item;
+
+	item = bench_splaydir_lower_bound(set, key);
+
+	return item && item->key == key;
+}
+
+static bool bench_splaydir_erase(void *ctx, uint64_t key)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct bench_splaydir_item *item;
+
+	item = bench_splaydir_lower_bound(set, key);
+	if (!item || item->key != key)
+		return false;
+
+	splay_dir_erase(&item->splay, &set->root);
+	splay_pool_free(&set->pool, item);
+
+	return true;
+}
+
+static bool bench_splaydir_pop_min(void *ctx, uint64_t *key)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct bench_splaydir_item *item;
+	struct splay_dir_node *node;
+
+	node = splay_dir_first(&set->root);
+	if (!node)
+		return false;
+
+	item = splay_entry(node, struct bench_splaydir_item, splay);
+	*key = item->key;
+
+	splay_dir_erase(node, &set->root);
+	splay_pool_free(&set->pool, item);
+
+	return true;
+}
+
+static uint64_t bench_splaydir_range(void *ctx, uint64_t from, size_t count)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct bench_splaydir_item *item;
+	struct splay_dir_node *node;
+	uint64_t sum = 0;
+
+	item = bench_splaydir_lower_bound(set, from);
+	if (!item)
+		return sum;
+
+	for (node = &item->splay; node && count; node = splay_dir_next(node)) {
+		item = splay_entry(node, struct bench_splaydir_item, splay);
+		sum += item->key;
+		count--;
+	}
+
+	return sum;
+}
+
+#ifdef SPLAYTREE_STATS
+static uint64_t bench_splaydir_rotations(void *ctx)
+{
+	struct bench_splaydir *set = (struct bench_splaydir *)ctx;
+	struct splay_stats stats;
+
+	splay_dir_stats_snapshot(&set->root, &stats);
+
+	return stats.zig + 2 * (stats.zigzig + stats.zigzag);
+}
+#endif
+
+const struct bench_backend bench_backend_splaydir = {
+	"splaydir",
+	0,
+	bench_splaydir_create,
+	bench_splaydir_destroy,
+	bench_splaydir_insert,
+	bench_splaydir_find,
+	bench_splaydir_erase,
+	bench_splaydir_pop_min,
+	bench_splaydir_range,
+#ifdef SPLAYTREE_STATS
+	bench_splaydir_rotations,
+#else
+	NULL,
+#endif
+};
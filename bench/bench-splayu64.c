@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../splaypool.h"
+#include "../splaytree.h"
+#include "bench.h"
+
+struct bench_splayu64 {
+	struct splay_u64_root root;
+	struct splay_pool pool;
+};
+
+static void *bench_splayu64_create(size_t capacity)
+{
+	struct bench_splayu64 *set;
+
+	(void)capacity;
+
+	set = (struct bench_splayu64 *)malloc(sizeof(*set));
+	if (!set)
+		abort();
+
+	INIT_SPLAY_U64_ROOT(&set->root);
+	splay_pool_init(&set->pool, sizeof(struct splay_u64_node), 0, 0);
+
+	return set;
+}
+
+static void bench_splayu64_destroy(void *ctx)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+
+	splay_pool_free_all(&set->pool);
+	free(set);
+}
+
+static void bench_splayu64_insert(void *ctx, uint64_t key)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+	struct splay_u64_node *node;
+
+	node = (struct splay_u64_node *)splay_pool_alloc(&set->pool);
+	if (!node)
+		abort();
+
+	node->key = key;
+	splay_u64_insert(node, &set->root);
+}
+
+static bool bench_splayu64_find(void *ctx, uint64_t key)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+
+	return splay_u64_find(&set->root, key) != NULL;
+}
+
+static bool bench_splayu64_erase(void *ctx, uint64_t key)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+	struct splay_u64_node *node;
+
+	node = splay_u64_find(&set->root, key);
+	if (!node)
+		return false;
+
+	splay_u64_erase(node, &set->root);
+	splay_pool_free(&set->pool, node);
+
+	return true;
+}
+
+static bool bench_splayu64_pop_min(void *ctx, uint64_t *key)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+	struct splay_u64_node *node;
+
+	node = splay_u64_first(&set->root);
+	if (!node)
+		return false;
+
+	*key = node->key;
+
+	splay_u64_erase(node, &set->root);
+	splay_pool_free(&set->pool, node);
+
+	return true;
+}
+
+static uint64_t bench_splayu64_range(void *ctx, uint64_t from, size_t count)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+	struct splay_u64_node *node;
+	uint64_t sum = 0;
+
+	node = splay_u64_lower_bound(&set->root, from);
+	for (; node && count; node = splay_u64_next(node)) {
+		sum += node->key;
+		count--;
+	}
+
+	return sum;
+}
+
+#ifdef SPLAYTREE_STATS
+static uint64_t bench_splayu64_rotations(void *ctx)
+{
+	struct bench_splayu64 *set = (struct bench_splayu64 *)ctx;
+	struct splay_stats stats;
+
+	splay_dir_stats_snapshot(&set->root.dir, &stats);
+
+	return stats.zig + 2 * (stats.zigzig + stats.zigzag);
+}
+#endif
+
+const struct bench_backend bench_backend_splayu64 = {
+	"splayu64",
+	0,
+	bench_splayu64_create,
+	bench_splayu64_destroy,
+	bench_splayu64_insert,
+	bench_splayu64_find,
+	bench_splayu64_erase,
+	bench_splayu64_pop_min,
+	bench_splayu64_range,
+#ifdef SPLAYTREE_STATS
+	bench_splayu64_rotations,
+#else
+	NULL,
+#endif
+};
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "bench.h"
+
+/* std::set and std::map are red-black trees in all common C++ libraries.
+ * They are used as the red-black tree reference for the splay trees. The
+ * map additionally stores a value next to each key like the entries of the
+ * intrusive trees.
+ */
+typedef std::set<uint64_t> bench_stdmap_set;
+typedef std::map<uint64_t, uint64_t> bench_stdmap_map;
+
+static void bench_stdmap_add(bench_stdmap_set *set, uint64_t key)
+{
+	set->insert(key);
+}
+
+static void bench_stdmap_add(bench_stdmap_map *map, uint64_t key)
+{
+	map->insert(std::make_pair(key, key));
+}
+
+static uint64_t bench_stdmap_key(bench_stdmap_set::const_iterator it)
+{
+	return *it;
+}
+
+static uint64_t bench_stdmap_key(bench_stdmap_map::const_iterator it)
+{
+	return it->first;
+}
+
+template <typename T>
+static void *bench_stdmap_create(size_t capacity)
+{
+	(void)capacity;
+
+	return new T();
+}
+
+template <typename T>
+static void bench_stdmap_destroy(void *ctx)
+{
+	delete static_cast<T *>(ctx);
+}
+
+template <typename T>
+static void bench_stdmap_insert(void *ctx, uint64_t key)
+{
+	bench_stdmap_add(static_cast<T *>(ctx), key);
+}
+
+template <typename T>
+static bool bench_stdmap_find(void *ctx, uint64_t key)
+{
+	T *set = static_cast<T *>(ctx);
+
+	return set->find(key) != set->end();
+}
+
+template <typename T>
+static bool bench_stdmap_erase(void *ctx, uint64_t key)
+{
+	return static_cast<T *>(ctx)->erase(key) > 0;
+}
+
+template <typename T>
+static bool bench_stdmap_pop_min(void *ctx, uint64_t *key)
+{
+	T *set = static_cast<T *>(ctx);
+
+	if (set->empty())
+		return false;
+
+	*key = bench_stdmap_key(set->begin());
+	set->erase(set->begin());
+
+	return true;
+}
+
+template <typename T>
+static uint64_t bench_stdmap_range(void *ctx, uint64_t from, size_t count)
+{
+	T *set = static_cast<T *>(ctx);
+	typename T::const_iterator it;
+	uint64_t sum = 0;
+
+	for (it = set->lower_bound(from); it != set->end() && count; ++it) {
+		sum += bench_stdmap_key(it);
+		count--;
+	}
+
+	return sum;
+}
+
+extern "C" const struct bench_backend bench_backend_stdset = {
+	"std::set",
+	0,
+	bench_stdmap_create<bench_stdmap_set>,
+	bench_stdmap_destroy<bench_stdmap_set>,
+	bench_stdmap_insert<bench_stdmap_set>,
+	bench_stdmap_find<bench_stdmap_set>,
+	bench_stdmap_erase<bench_stdmap_set>,
+	bench_stdmap_pop_min<bench_stdmap_set>,
+	bench_stdmap_range<bench_stdmap_set>,
+	NULL,
+};
+
+extern "C" const struct bench_backend bench_backend_stdmap = {
+	"std::map",
+	0,
+	bench_stdmap_create<bench_stdmap_map>,
+	bench_stdmap_destroy<bench_stdmap_map>,
+	bench_stdmap_insert<bench_stdmap_map>,
+	bench_stdmap_find<bench_stdmap_map>,
+	bench_stdmap_erase<bench_stdmap_map>,
+	bench_stdmap_pop_min<bench_stdmap_map>,
+	bench_stdmap_range<bench_stdmap_map>,
+	NULL,
+};
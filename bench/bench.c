@@ -0,0 +1,538 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "perf.h"
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+#define BENCH_ZIPF_THETA	0.99
+#define BENCH_RANGE_LEN		64
+
+enum bench_dist {
+	BENCH_DIST_UNIFORM,
+	BENCH_DIST_ZIPF,
+	BENCH_DIST_SEQUENTIAL,
+	BENCH_DIST_WORKSET,
+	BENCH_DIST_SLIDING,
+};
+
+static const char * const bench_dist_names[] = {
+	"uniform",
+	"zipf",
+	"seq",
+	"workset",
+	"sliding",
+};
+
+static const struct bench_backend * const bench_backends[] = {
+	&bench_backend_splay,
+	&bench_backend_splaydir,
+	&bench_backend_splayu64,
+	&bench_backend_stdset,
+	&bench_backend_stdmap,
+	&bench_backend_array,
+};
+
+/**
+ * struct bench_keygen - generator for key streams of a distribution
+ * @dist: distribution of the generated keys
+ * @n: number of keys in the set (keys are 0..n-1)
+ * @rng: state of the xorshift random number generator
+ * @i: number of generated keys
+ * @scramble: multiplier to spread zipf ranks over the key space
+ * @zetan: zeta(n, theta) for the zipf distribution
+ * @zeta2: zeta(2, theta) for the zipf distribution
+ * @alpha: 1 / (1 - theta) for the zipf distribution
+ * @eta: helper constant for the zipf distribution
+ * @hot_base: first key of the current working set
+ * @hot_size: size of the working set and of the sliding window
+ * @shift_period: number of keys after which the working set moves
+ */
+struct bench_keygen {
+	enum bench_dist dist;
+	size_t n;
+	uint64_t rng;
+	uint64_t i;
+	uint64_t scramble;
+	double zetan;
+	double zeta2;
+	double alpha;
+	double eta;
+	uint64_t hot_base;
+	uint64_t hot_size;
+	uint64_t shift_period;
+};
+
+static volatile uint64_t bench_sink;
+static struct bench_perf bench_perf;
+static bool bench_perf_enabled;
+
+static uint64_t bench_rand(uint64_t *state)
+{
+	uint64_t x = *state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+
+	return x * UINT64_C(2685821657736338717);
+}
+
+static double bench_rand_double(uint64_t *state)
+{
+	return (bench_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t bench_gcd(uint64_t a, uint64_t b)
+{
+	uint64_t t;
+
+	while (b) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+static double bench_zeta(size_t n, double theta)
+{
+	double sum = 0;
+	size_t i;
+
+	for (i = 1; i <= n; i++)
+		sum += 1.0 / pow((double)i, theta);
+
+	return sum;
+}
+
+static void bench_keygen_init(struct bench_keygen *gen, enum bench_dist dist,
+			      size_t n, uint64_t seed, double zetan)
+{
+	memset(gen, 0, sizeof(*gen));
+
+	gen->dist = dist;
+	gen->n = n;
+	gen->rng = seed | 1;
+
+	/* spread hot zipf ranks over the whole key space */
+	gen->scramble = UINT64_C(11400714819323198485) % n;
+	while (gen->scramble == 0 || bench_gcd(gen->scramble, n) != 1)
+		gen->scramble++;
+
+	gen->zetan = zetan;
+	gen->zeta2 = bench_zeta(2, BENCH_ZIPF_THETA);
+	gen->alpha = 1.0 / (1.0 - BENCH_ZIPF_THETA);
+	gen->eta = (1.0 - pow(2.0 / n, 1.0 - BENCH_ZIPF_THETA)) /
+		   (1.0 - gen->zeta2 / zetan);
+
+	gen->hot_size = n / 100 ? n / 100 : 1;
+	gen->shift_period = n / 10 ? n / 10 : 1;
+}
+
+static uint64_t bench_zipf_rank(struct bench_keygen *gen)
+{
+	double u = bench_rand_double(&gen->rng);
+	double uz = u * gen->zetan;
+	uint64_t rank;
+
+	if (uz < 1.0)
+		return 0;
+
+	if (uz < 1.0 + pow(0.5, BENCH_ZIPF_THETA))
+		return 1;
+
+	rank = (uint64_t)(gen->n * pow(gen->eta * u - gen->eta + 1.0,
+				       gen->alpha));
+	if (rank >= gen->n)
+		rank = gen->n - 1;
+
+	return rank;
+}
+
+static uint64_t bench_keygen_next(struct bench_keygen *gen)
+{
+	uint64_t key = 0;
+	uint64_t i = gen->i++;
+
+	switch (gen->dist) {
+	case BENCH_DIST_UNIFORM:
+		key = bench_rand(&gen->rng) % gen->n;
+		break;
+	case BENCH_DIST_ZIPF:
+		key = (bench_zipf_rank(gen) * gen->scramble) % gen->n;
+		break;
+	case BENCH_DIST_SEQUENTIAL:
+		key = i % gen->n;
+		break;
+	case BENCH_DIST_WORKSET:
+		if (i % gen->shift_period == 0)
+			gen->hot_base = bench_rand(&gen->rng) % gen->n;
+
+		key = gen->hot_base + bench_rand(&gen->rng) % gen->hot_size;
+		key %= gen->n;
+		break;
+	case BENCH_DIST_SLIDING:
+		key = i + bench_rand(&gen->rng) % gen->hot_size;
+		key %= gen->n;
+		break;
+	}
+
+	return key;
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t bench_rotations(const struct bench_backend *backend,
+				void *set)
+{
+	if (!backend->rotations)
+		return 0;
+
+	return backend->rotations(set);
+}
+
+/**
+ * struct bench_phase - measurement of a single benchmark phase
+ * @start: start time in ns
+ * @rotations: number of rotations at the start
+ */
+struct bench_phase {
+	double start;
+	uint64_t rotations;
+};
+
+static void bench_phase_start(struct bench_phase *phase,
+			      const struct bench_backend *backend, void *set)
+{
+	phase->rotations = bench_rotations(backend, set);
+
+	if (bench_perf_enabled)
+		bench_perf_start(&bench_perf);
+
+	phase->start = bench_now();
+}
+
+static void bench_phase_end(const struct bench_phase *phase, size_t n,
+			    enum bench_dist dist,
+			    const struct bench_backend *backend, const char *op,
+			    size_t ops, void *set)
+{
+	double ns = bench_now() - phase->start;
+	struct bench_perf_values values;
+	size_t i;
+
+	if (bench_perf_enabled)
+		bench_perf_stop(&bench_perf, &values);
+
+	printf("%-10zu %-8s %-9s %-7s %10.1f", n, bench_dist_names[dist],
+	       backend->name, op, ops ? ns / ops : 0.0);
+
+	if (backend->rotations)
+		printf(" %8.2f", ops ? (double)(bench_rotations(backend, set) -
+						phase->rotations) / ops : 0.0);
+	else
+		printf(" %8s", "-");
+
+	if (bench_perf_enabled) {
+		for (i = 0; i < BENCH_PERF_NUM; i++) {
+			if (values.valid[i] && ops)
+				printf(" %8.2f", (double)values.value[i] / ops);
+			else
+				printf(" %8s", "-");
+		}
+	}
+
+	printf("\n");
+}
+
+static void bench_run(size_t n, enum bench_dist dist,
+		      const struct bench_backend *backend, uint64_t seed,
+		      double zetan, uint64_t *keys, uint8_t *erased)
+{
+	struct bench_phase phase;
+	struct bench_keygen gen;
+	uint64_t sum = 0;
+	size_t used;
+	size_t fill;
+	size_t ops;
+	uint64_t key;
+	void *set;
+	size_t i, j;
+
+	if (backend->max_size && n > backend->max_size) {
+		printf("%-10zu %-8s %-9s %-7s %10s %8s\n", n,
+		       bench_dist_names[dist], backend->name, "all",
+		       "skipped", "-");
+		return;
+	}
+
+	/* insert order is ascending or random */
+	for (i = 0; i < n; i++)
+		keys[i] = i;
+
+	if (dist != BENCH_DIST_SEQUENTIAL) {
+		bench_keygen_init(&gen, BENCH_DIST_UNIFORM, n, seed, zetan);
+		for (i = n - 1; i > 0; i--) {
+			j = bench_rand(&gen.rng) % (i + 1);
+
+			key = keys[i];
+			keys[i] = keys[j];
+			keys[j] = key;
+		}
+	}
+
+	set = backend->create(n);
+
+	bench_phase_start(&phase, backend, set);
+	for (i = 0; i < n; i++)
+		backend->insert(set, keys[i]);
+	bench_phase_end(&phase, n, dist, backend, "insert", n, set);
+
+	/* keys are generated before each phase to keep the cost of the key
+	 * generator (pow for zipf) out of the measurement
+	 */
+	bench_keygen_init(&gen, dist, n, seed + 1, zetan);
+	for (i = 0; i < n; i++)
+		keys[i] = bench_keygen_next(&gen);
+
+	bench_phase_start(&phase, backend, set);
+	for (i = 0; i < n; i++)
+		sum += backend->find(set, keys[i]);
+	bench_phase_end(&phase, n, dist, backend, "find", n, set);
+
+	ops = n / BENCH_RANGE_LEN ? n / BENCH_RANGE_LEN : 1;
+	bench_keygen_init(&gen, dist, n, seed + 2, zetan);
+	for (i = 0; i < ops; i++)
+		keys[i] = bench_keygen_next(&gen);
+
+	bench_phase_start(&phase, backend, set);
+	for (i = 0; i < ops; i++)
+		sum += backend->range(set, keys[i], BENCH_RANGE_LEN);
+	bench_phase_end(&phase, n, dist, backend, "range", ops, set);
+
+	/* erase half of the keys in the order of the distribution, repeated
+	 * keys are skipped
+	 */
+	memset(erased, 0, n);
+	ops = n / 2;
+	used = 0;
+	bench_keygen_init(&gen, dist, n, seed + 3, zetan);
+	for (i = 0; i < n && used < ops; i++) {
+		key = bench_keygen_next(&gen);
+		if (erased[key])
+			continue;
+
+		erased[key] = 1;
+		keys[used++] = key;
+	}
+
+	/* skewed distributions mostly repeat their hot keys after n draws. The
+	 * missing keys are a random selection of the keys which are not erased
+	 */
+	fill = used;
+	for (key = 0; key < n; key++) {
+		if (!erased[key])
+			keys[fill++] = key;
+	}
+
+	for (i = used; i < ops; i++) {
+		j = i + bench_rand(&gen.rng) % (fill - i);
+
+		key = keys[i];
+		keys[i] = keys[j];
+		keys[j] = key;
+	}
+
+	bench_phase_start(&phase, backend, set);
+	for (i = 0; i < ops; i++)
+		sum += backend->erase(set, keys[i]);
+	bench_phase_end(&phase, n, dist, backend, "erase", ops, set);
+
+	ops = n - ops;
+	bench_phase_start(&phase, backend, set);
+	for (i = 0; i < ops; i++) {
+		if (!backend->pop_min(set, &key))
+			abort();
+
+		sum += key;
+	}
+	bench_phase_end(&phase, n, dist, backend, "popmin", ops, set);
+
+	backend->destroy(set);
+	bench_sink += sum;
+}
+
+static void bench_usage(const char *prog)
+{
+	size_t i;
+
+	fprintf(stderr,
+		"Usage: %s [-n SIZE]... [-d DIST]... [-b BACKEND]... [-s SEED] [-p]\n",
+		prog);
+	fprintf(stderr, "  -p: report hardware counters per operation\n");
+
+	fprintf(stderr, "  DIST:");
+	for (i = 0; i < ARRAY_SIZE(bench_dist_names); i++)
+		fprintf(stderr, " %s", bench_dist_names[i]);
+	fprintf(stderr, "\n");
+
+	fprintf(stderr, "  BACKEND:");
+	for (i = 0; i < ARRAY_SIZE(bench_backends); i++)
+		fprintf(stderr, " %s", bench_backends[i]->name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static const size_t default_sizes[] = { 1000, 10000, 100000, 1000000 };
+	bool backend_sel[ARRAY_SIZE(bench_backends)] = { false };
+	bool dist_sel[ARRAY_SIZE(bench_dist_names)] = { false };
+	bool any_backend = false;
+	bool any_dist = false;
+	size_t sizes[32];
+	size_t nsizes = 0;
+	uint64_t seed = 1;
+	size_t max_size = 0;
+	uint8_t *erased;
+	uint64_t *keys;
+	double zetan;
+	size_t i, j, k;
+	int arg;
+
+	for (arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "-p") == 0) {
+			bench_perf_enabled = true;
+			continue;
+		}
+
+		if (arg + 1 >= argc) {
+			bench_usage(argv[0]);
+			return 1;
+		}
+
+		if (strcmp(argv[arg], "-n") == 0) {
+			if (nsizes >= ARRAY_SIZE(sizes))
+				return 1;
+
+			sizes[nsizes] = strtoull(argv[++arg], NULL, 0);
+			if (!sizes[nsizes]) {
+				bench_usage(argv[0]);
+				return 1;
+			}
+			nsizes++;
+		} else if (strcmp(argv[arg], "-d") == 0) {
+			arg++;
+			for (i = 0; i < ARRAY_SIZE(bench_dist_names); i++) {
+				if (strcmp(argv[arg], bench_dist_names[i]) == 0)
+					break;
+			}
+
+			if (i == ARRAY_SIZE(bench_dist_names)) {
+				bench_usage(argv[0]);
+				return 1;
+			}
+
+			dist_sel[i] = true;
+			any_dist = true;
+		} else if (strcmp(argv[arg], "-b") == 0) {
+			arg++;
+			for (i = 0; i < ARRAY_SIZE(bench_backends); i++) {
+				if (strcmp(argv[arg], bench_backends[i]->name) == 0)
+					break;
+			}
+
+			if (i == ARRAY_SIZE(bench_backends)) {
+				bench_usage(argv[0]);
+				return 1;
+			}
+
+			backend_sel[i] = true;
+			any_backend = true;
+		} else if (strcmp(argv[arg], "-s") == 0) {
+			seed = strtoull(argv[++arg], NULL, 0);
+		} else {
+			bench_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!nsizes) {
+		memcpy(sizes, default_sizes, sizeof(default_sizes));
+		nsizes = ARRAY_SIZE(default_sizes);
+	}
+
+	for (i = 0; i < nsizes; i++) {
+		if (sizes[i] > max_size)
+			max_size = sizes[i];
+	}
+
+	keys = (uint64_t *)malloc(max_size * sizeof(*keys));
+	erased = (uint8_t *)malloc(max_size);
+	if (!keys || !erased)
+		return 1;
+
+	if (bench_perf_enabled && bench_perf_open(&bench_perf) == 0) {
+		fprintf(stderr, "%s: no hardware counters available\n",
+			argv[0]);
+		bench_perf_enabled = false;
+	}
+
+	printf("%-10s %-8s %-9s %-7s %10s %8s", "size", "dist", "backend",
+	       "op", "ns/op", "rot/op");
+	if (bench_perf_enabled) {
+		for (i = 0; i < BENCH_PERF_NUM; i++)
+			printf(" %8s", bench_perf_names[i]);
+	}
+	printf("\n");
+
+	for (i = 0; i < nsizes; i++) {
+		zetan = bench_zeta(sizes[i], BENCH_ZIPF_THETA);
+
+		for (j = 0; j < ARRAY_SIZE(bench_dist_names); j++) {
+			if (any_dist && !dist_sel[j])
+				continue;
+
+			for (k = 0; k < ARRAY_SIZE(bench_backends); k++) {
+				if (any_backend && !backend_sel[k])
+					continue;
+
+				bench_run(sizes[i], (enum bench_dist)j,
+					  bench_backends[k], seed, zetan, keys,
+					  erased);
+			}
+		}
+	}
+
+	if (bench_perf_enabled)
+		bench_perf_close(&bench_perf);
+
+	free(erased);
+	free(keys);
+
+	return 0;
+}
@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions benchmark
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYTREE_BENCH_H__
+#define __SPLAYTREE_BENCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * struct bench_backend - ordered set implementation under test
+ * @name: short name used in the report
+ * @max_size: largest number of elements the backend can handle in a
+ *  reasonable time, 0 for unlimited
+ * @create: allocate empty set for up to @capacity elements
+ * @destroy: free set and all its elements
+ * @insert: add new (not yet existing) key
+ * @find: search key and return whether it was found
+ * @erase: remove key and return whether it was found
+ * @pop_min: remove smallest key and return whether set was not empty
+ * @range: visit up to @count keys starting at the first key not smaller than
+ *  @from and return sum of the visited keys
+ * @rotations: return number of rotations done so far, can be NULL
+ */
+struct bench_backend {
+	const char *name;
+	size_t max_size;
+	void *(*create)(size_t capacity);
+	void (*destroy)(void *set);
+	void (*insert)(void *set, uint64_t key);
+	bool (*find)(void *set, uint64_t key);
+	bool (*erase)(void *set, uint64_t key);
+	bool (*pop_min)(void *set, uint64_t *key);
+	uint64_t (*range)(void *set, uint64_t from, size_t count);
+	uint64_t (*rotations)(void *set);
+};
+
+extern const struct bench_backend bench_backend_splay;
+extern const struct bench_backend bench_backend_splaydir;
+extern const struct bench_backend bench_backend_splayu64;
+extern const struct bench_backend bench_backend_array;
+extern const struct bench_backend bench_backend_stdset;
+extern const struct bench_backend bench_backend_stdmap;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYTREE_BENCH_H__ */
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark - hardware counters
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "perf.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char * const bench_perf_names[BENCH_PERF_NUM] = {
+	"cyc",
+	"ins",
+	"l1dm",
+	"llcm",
+	"tlbm",
+	"brm",
+};
+
+#if defined(__linux__)
+/**
+ * struct bench_perf_read - data returned by read() on a counter
+ * @value: raw number of events
+ * @time_enabled: time the counter was enabled
+ * @time_running: time the counter was actually counting (multiplexing)
+ */
+struct bench_perf_read {
+	uint64_t value;
+	uint64_t time_enabled;
+	uint64_t time_running;
+};
+
+/**
+ * bench_perf_cache() - Build config for a generic hardware cache event
+ * @cache: PERF_COUNT_HW_CACHE_* id of the cache
+ * @op: PERF_COUNT_HW_CACHE_OP_* operation
+ * @result: PERF_COUNT_HW_CACHE_RESULT_* result
+ *
+ * Return: config value for struct perf_event_attr
+ */
+static uint64_t bench_perf_cache(uint64_t cache, uint64_t op, uint64_t result)
+{
+	return cache | (op << 8) | (result << 16);
+}
+
+/**
+ * bench_perf_open_counter() - Open single counter for current thread
+ * @type: PERF_TYPE_* of the event
+ * @config: event config
+ *
+ * Return: file descriptor of the counter, -1 when not available
+ */
+static int bench_perf_open_counter(uint32_t type, uint64_t config)
+{
+	struct perf_event_attr attr;
+	long fd;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+			   PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if (fd < 0)
+		return -1;
+
+	return (int)fd;
+}
+#endif
+
+/**
+ * bench_perf_open() - Open all hardware counters for current thread
+ * @perf: pointer to counters
+ *
+ * Counters which are not supported by the CPU, the kernel or which are not
+ * allowed (perf_event_paranoid) are skipped.
+ *
+ * Return: number of available counters
+ */
+int bench_perf_open(struct bench_perf *perf)
+{
+	int available = 0;
+	size_t i;
+
+	for (i = 0; i < BENCH_PERF_NUM; i++)
+		perf->fd[i] = -1;
+
+#if defined(__linux__)
+	perf->fd[BENCH_PERF_CYCLES] =
+		bench_perf_open_counter(PERF_TYPE_HARDWARE,
+					PERF_COUNT_HW_CPU_CYCLES);
+	perf->fd[BENCH_PERF_INSTRUCTIONS] =
+		bench_perf_open_counter(PERF_TYPE_HARDWARE,
+					PERF_COUNT_HW_INSTRUCTIONS);
+	perf->fd[BENCH_PERF_L1D_MISSES] =
+		bench_perf_open_counter(PERF_TYPE_HW_CACHE,
+					bench_perf_cache(PERF_COUNT_HW_CACHE_L1D,
+							 PERF_COUNT_HW_CACHE_OP_READ,
+							 PERF_COUNT_HW_CACHE_RESULT_MISS));
+	perf->fd[BENCH_PERF_LLC_MISSES] =
+		bench_perf_open_counter(PERF_TYPE_HARDWARE,
+					PERF_COUNT_HW_CACHE_MISSES);
+	perf->fd[BENCH_PERF_DTLB_MISSES] =
+		bench_perf_open_counter(PERF_TYPE_HW_CACHE,
+					bench_perf_cache(PERF_COUNT_HW_CACHE_DTLB,
+							 PERF_COUNT_HW_CACHE_OP_READ,
+							 PERF_COUNT_HW_CACHE_RESULT_MISS));
+	perf->fd[BENCH_PERF_BRANCH_MISSES] =
+		bench_perf_open_counter(PERF_TYPE_HARDWARE,
+					PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+
+	for (i = 0; i < BENCH_PERF_NUM; i++) {
+		if (perf->fd[i] >= 0)
+			available++;
+	}
+
+	return available;
+}
+
+/**
+ * bench_perf_start() - Reset and start all available counters
+ * @perf: pointer to counters
+ */
+void bench_perf_start(struct bench_perf *perf)
+{
+#if defined(__linux__)
+	size_t i;
+
+	for (i = 0; i < BENCH_PERF_NUM; i++) {
+		if (perf->fd[i] < 0)
+			continue;
+
+		ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+#else
+	(void)perf;
+#endif
+}
+
+/**
+ * bench_perf_stop() - Stop all available counters and read their values
+ * @perf: pointer to counters
+ * @values: returns values of the counters since bench_perf_start
+ *
+ * Values of multiplexed counters are scaled to the full measurement time.
+ */
+void bench_perf_stop(struct bench_perf *perf,
+		     struct bench_perf_values *values)
+{
+	size_t i;
+#if defined(__linux__)
+	struct bench_perf_read data;
+
+	for (i = 0; i < BENCH_PERF_NUM; i++) {
+		if (perf->fd[i] >= 0)
+			ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+	}
+#endif
+
+	for (i = 0; i < BENCH_PERF_NUM; i++) {
+		values->valid[i] = false;
+		values->value[i] = 0;
+
+#if defined(__linux__)
+		if (perf->fd[i] < 0)
+			continue;
+
+		if (read(perf->fd[i], &data, sizeof(data)) != sizeof(data))
+			continue;
+
+		if (!data.time_running)
+			continue;
+
+		values->valid[i] = true;
+		values->value[i] = data.value;
+		if (data.time_running < data.time_enabled)
+			values->value[i] = (uint64_t)((double)data.value *
+						      data.time_enabled /
+						      data.time_running);
+#endif
+	}
+}
+
+/**
+ * bench_perf_close() - Close all hardware counters
+ * @perf: pointer to counters
+ */
+void bench_perf_close(struct bench_perf *perf)
+{
+	size_t i;
+
+	for (i = 0; i < BENCH_PERF_NUM; i++) {
+#if defined(__linux__)
+		if (perf->fd[i] >= 0)
+			close(perf->fd[i]);
+#endif
+		perf->fd[i] = -1;
+	}
+}
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions benchmark - hardware counters
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYTREE_BENCH_PERF_H__
+#define __SPLAYTREE_BENCH_PERF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * enum bench_perf_counter - hardware counters read per benchmark phase
+ * @BENCH_PERF_CYCLES: CPU cycles
+ * @BENCH_PERF_INSTRUCTIONS: retired instructions
+ * @BENCH_PERF_L1D_MISSES: L1 data cache read misses
+ * @BENCH_PERF_LLC_MISSES: last level cache misses
+ * @BENCH_PERF_DTLB_MISSES: data TLB read misses
+ * @BENCH_PERF_BRANCH_MISSES: mispredicted branches
+ * @BENCH_PERF_NUM: number of counters
+ */
+enum bench_perf_counter {
+	BENCH_PERF_CYCLES,
+	BENCH_PERF_INSTRUCTIONS,
+	BENCH_PERF_L1D_MISSES,
+	BENCH_PERF_LLC_MISSES,
+	BENCH_PERF_DTLB_MISSES,
+	BENCH_PERF_BRANCH_MISSES,
+	BENCH_PERF_NUM
+};
+
+/**
+ * struct bench_perf - hardware counters of the current thread
+ * @fd: perf_event file descriptor of each counter, -1 when not available
+ */
+struct bench_perf {
+	int fd[BENCH_PERF_NUM];
+};
+
+/**
+ * struct bench_perf_values - counter values of a measured phase
+ * @valid: counter was available and was running during the phase
+ * @value: (multiplexing scaled) number of events
+ */
+struct bench_perf_values {
+	bool valid[BENCH_PERF_NUM];
+	uint64_t value[BENCH_PERF_NUM];
+};
+
+extern const char * const bench_perf_names[BENCH_PERF_NUM];
+
+int bench_perf_open(struct bench_perf *perf);
+void bench_perf_start(struct bench_perf *perf);
+void bench_perf_stop(struct bench_perf *perf,
+		     struct bench_perf_values *values);
+void bench_perf_close(struct bench_perf *perf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYTREE_BENCH_PERF_H__ */
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark - trace replay
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "trace.h"
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+static const struct bench_backend * const replay_backends[] = {
+	&bench_backend_splay,
+	&bench_backend_splaydir,
+	&bench_backend_splayu64,
+	&bench_backend_stdset,
+	&bench_backend_stdmap,
+	&bench_backend_array,
+};
+
+static const char * const replay_op_names[] = {
+	"all",
+	"insert",
+	"find",
+	"erase",
+	"popmin",
+};
+
+/**
+ * struct replay_stats - results for one operation type
+ * @latencies: latency of each operation in ns
+ * @count: number of operations
+ * @rotations: number of rotations done by the operations
+ */
+struct replay_stats {
+	uint32_t *latencies;
+	size_t count;
+	uint64_t rotations;
+};
+
+static volatile uint64_t replay_sink;
+
+static uint64_t replay_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static int replay_cmp_latency(const void *p1, const void *p2)
+{
+	const uint32_t *l1 = (const uint32_t *)p1;
+	const uint32_t *l2 = (const uint32_t *)p2;
+
+	if (*l1 < *l2)
+		return -1;
+
+	return *l1 > *l2;
+}
+
+static uint32_t replay_percentile(const struct replay_stats *stats,
+				  double percentile)
+{
+	size_t pos;
+
+	pos = (size_t)(stats->count * percentile / 100.0);
+	if (pos >= stats->count)
+		pos = stats->count - 1;
+
+	return stats->latencies[pos];
+}
+
+static void replay_report(const char *name, struct replay_stats *stats,
+			  const struct bench_backend *backend)
+{
+	if (!stats->count)
+		return;
+
+	qsort(stats->latencies, stats->count, sizeof(*stats->latencies),
+	      replay_cmp_latency);
+
+	printf("%-7s %10zu %7u %7u %7u %7u %9u", name, stats->count,
+	       replay_percentile(stats, 50), replay_percentile(stats, 90),
+	       replay_percentile(stats, 99), replay_percentile(stats, 99.9),
+	       stats->latencies[stats->count - 1]);
+
+	if (backend->rotations)
+		printf(" %8.2f\n", (double)stats->rotations / stats->count);
+	else
+		printf(" %8s\n", "-");
+}
+
+static uint64_t replay_rotations(const struct bench_backend *backend,
+				 void *set)
+{
+	if (!backend->rotations)
+		return 0;
+
+	return backend->rotations(set);
+}
+
+/**
+ * replay_find_duplicates() - Mark inserts of already existing keys
+ * @entries: operations of the trace
+ * @count: number of entries in @entries
+ * @duplicate: returns !0 for each insert of an already existing key
+ *
+ * The backends expect that only new keys are inserted. Some of them silently
+ * ignore an existing key while others store it a second time. Recorded traces
+ * can still contain such inserts. The trace is therefore simulated once with
+ * the std::set backend and the duplicate inserts are skipped by all backends.
+ *
+ * Return: number of duplicate inserts
+ */
+static size_t replay_find_duplicates(const struct bench_trace_entry *entries,
+				     size_t count, uint8_t *duplicate)
+{
+	const struct bench_backend *model = &bench_backend_stdset;
+	size_t duplicates = 0;
+	uint64_t key;
+	void *set;
+	size_t i;
+
+	set = model->create(count);
+
+	for (i = 0; i < count; i++) {
+		duplicate[i] = 0;
+		key = entries[i].key;
+
+		switch (entries[i].op) {
+		case BENCH_TRACE_INSERT:
+			if (model->find(set, key)) {
+				duplicate[i] = 1;
+				duplicates++;
+			} else {
+				model->insert(set, key);
+			}
+			break;
+		case BENCH_TRACE_ERASE:
+			model->erase(set, key);
+			break;
+		case BENCH_TRACE_POP_MIN:
+			model->pop_min(set, &key);
+			break;
+		}
+	}
+
+	model->destroy(set);
+
+	return duplicates;
+}
+
+static int replay_run(const struct bench_backend *backend,
+		      const struct bench_trace_entry *entries,
+		      const uint8_t *duplicate, size_t count)
+{
+	struct replay_stats stats[ARRAY_SIZE(replay_op_names)];
+	uint64_t rotations;
+	uint64_t duration;
+	uint64_t latency;
+	uint64_t total = 0;
+	uint64_t start;
+	uint64_t key;
+	size_t inserts = 0;
+	int ret = -1;
+	void *set;
+	size_t i;
+	uint8_t op;
+
+	memset(stats, 0, sizeof(stats));
+	for (i = 0; i < ARRAY_SIZE(stats); i++) {
+		stats[i].latencies = (uint32_t *)malloc((count + 1) *
+							sizeof(uint32_t));
+		if (!stats[i].latencies)
+			goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (entries[i].op == BENCH_TRACE_INSERT && !duplicate[i])
+			inserts++;
+	}
+
+	if (backend->max_size && inserts > backend->max_size) {
+		printf("%s: skipped (more than %zu inserts)\n", backend->name,
+		       backend->max_size);
+		ret = 0;
+		goto out;
+	}
+
+	set = backend->create(inserts);
+
+	for (i = 0; i < count; i++) {
+		if (duplicate[i])
+			continue;
+
+		op = entries[i].op;
+		key = entries[i].key;
+
+		rotations = replay_rotations(backend, set);
+		start = replay_now();
+
+		switch (op) {
+		case BENCH_TRACE_INSERT:
+			backend->insert(set, key);
+			break;
+		case BENCH_TRACE_FIND:
+			replay_sink += backend->find(set, key);
+			break;
+		case BENCH_TRACE_ERASE:
+			replay_sink += backend->erase(set, key);
+			break;
+		case BENCH_TRACE_POP_MIN:
+			replay_sink += backend->pop_min(set, &key);
+			break;
+		}
+
+		duration = replay_now() - start;
+		total += duration;
+		latency = duration > UINT32_MAX ? UINT32_MAX : duration;
+		rotations = replay_rotations(backend, set) - rotations;
+
+		stats[op].latencies[stats[op].count++] = (uint32_t)latency;
+		stats[op].rotations += rotations;
+		stats[0].latencies[stats[0].count++] = (uint32_t)latency;
+		stats[0].rotations += rotations;
+	}
+
+	backend->destroy(set);
+
+	printf("%s: %zu ops in %.3f s, %.3f Mops/s\n", backend->name,
+	       stats[0].count, total / 1e9,
+	       total ? stats[0].count * 1e3 / total : 0.0);
+	printf("%-7s %10s %7s %7s %7s %7s %9s %8s\n", "op", "count", "p50",
+	       "p90", "p99", "p99.9", "max", "rot/op");
+
+	for (i = 1; i < ARRAY_SIZE(stats); i++)
+		replay_report(replay_op_names[i], &stats[i], backend);
+	replay_report(replay_op_names[0], &stats[0], backend);
+
+	ret = 0;
+
+out:
+	for (i = 0; i < ARRAY_SIZE(stats); i++)
+		free(stats[i].latencies);
+
+	return ret;
+}
+
+static void replay_usage(const char *prog)
+{
+	size_t i;
+
+	fprintf(stderr, "Usage: %s [-b BACKEND]... TRACEFILE\n", prog);
+
+	fprintf(stderr, "  BACKEND:");
+	for (i = 0; i < ARRAY_SIZE(replay_backends); i++)
+		fprintf(stderr, " %s", replay_backends[i]->name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	bool backend_sel[ARRAY_SIZE(replay_backends)] = { false };
+	struct bench_trace_entry *entries;
+	bool any_backend = false;
+	uint8_t *duplicate;
+	size_t duplicates;
+	int ret = 0;
+	const char *path = NULL;
+	size_t count;
+	size_t i;
+	int arg;
+
+	for (arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+			arg++;
+			for (i = 0; i < ARRAY_SIZE(replay_backends); i++) {
+				if (strcmp(argv[arg], replay_backends[i]->name) == 0)
+					break;
+			}
+
+			if (i == ARRAY_SIZE(replay_backends)) {
+				replay_usage(argv[0]);
+				return 1;
+			}
+
+			backend_sel[i] = true;
+			any_backend = true;
+		} else if (!path && argv[arg][0] != '-') {
+			path = argv[arg];
+		} else {
+			replay_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!path) {
+		replay_usage(argv[0]);
+		return 1;
+	}
+
+	if (bench_trace_load(path, &entries, &count) < 0) {
+		fprintf(stderr, "%s: failed to load trace %s\n", argv[0], path);
+		return 1;
+	}
+
+	duplicate = (uint8_t *)malloc(count + 1);
+	if (!duplicate) {
+		free(entries);
+		return 1;
+	}
+
+	duplicates = replay_find_duplicates(entries, count, duplicate);
+	if (duplicates)
+		printf("skipping %zu inserts of already existing keys\n",
+		       duplicates);
+
+	for (i = 0; i < ARRAY_SIZE(replay_backends); i++) {
+		if (any_backend && !backend_sel[i])
+			continue;
+
+		if (replay_run(replay_backends[i], entries, duplicate,
+			       count) < 0) {
+			ret = 1;
+			break;
+		}
+	}
+
+	free(duplicate);
+	free(entries);
+
+	return ret;
+}
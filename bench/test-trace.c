@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark - trace format test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace.h"
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+static const char test_trace_path[] = "test-trace.tmp";
+
+static void test_trace_write_raw(const unsigned char *data, size_t len)
+{
+	FILE *fp;
+
+	fp = fopen(test_trace_path, "wb");
+	assert(fp);
+	assert(fwrite(data, 1, len, fp) == len);
+	assert(fclose(fp) == 0);
+}
+
+static void test_trace_round_trip(void)
+{
+	static const struct bench_trace_entry recorded[] = {
+		{ BENCH_TRACE_INSERT, 0 },
+		{ BENCH_TRACE_INSERT, UINT64_MAX },
+		{ BENCH_TRACE_FIND, UINT64_C(0x0123456789abcdef) },
+		{ BENCH_TRACE_ERASE, UINT64_C(0x8000000000000001) },
+		{ BENCH_TRACE_POP_MIN, 42 },
+	};
+	struct bench_trace_entry *entries;
+	size_t count;
+	FILE *fp;
+	size_t i;
+
+	fp = bench_trace_create(test_trace_path);
+	assert(fp);
+	for (i = 0; i < ARRAY_SIZE(recorded); i++)
+		assert(bench_trace_record(fp,
+					  (enum bench_trace_op)recorded[i].op,
+					  recorded[i].key) == 0);
+	assert(bench_trace_close(fp) == 0);
+
+	assert(bench_trace_load(test_trace_path, &entries, &count) == 0);
+	assert(count == ARRAY_SIZE(recorded));
+	for (i = 0; i < count; i++) {
+		assert(entries[i].op == recorded[i].op);
+		assert(entries[i].key == recorded[i].key);
+	}
+	free(entries);
+}
+
+static void test_trace_empty(void)
+{
+	struct bench_trace_entry *entries;
+	size_t count = 1;
+	FILE *fp;
+
+	fp = bench_trace_create(test_trace_path);
+	assert(fp);
+	assert(bench_trace_close(fp) == 0);
+
+	assert(bench_trace_load(test_trace_path, &entries, &count) == 0);
+	assert(count == 0);
+	free(entries);
+}
+
+static void test_trace_invalid(void)
+{
+	static const unsigned char bad_magic[] = {
+		'S', 'P', 'T', 'X', 1, 0, 0, 0,
+	};
+	static const unsigned char bad_version[] = {
+		'S', 'P', 'T', 'R', 2, 0, 0, 0,
+	};
+	static const unsigned char short_header[] = {
+		'S', 'P', 'T', 'R', 1,
+	};
+	static const unsigned char bad_op[] = {
+		'S', 'P', 'T', 'R', 1, 0, 0, 0,
+		5, 1, 0, 0, 0, 0, 0, 0, 0,
+	};
+	static const unsigned char no_op[] = {
+		'S', 'P', 'T', 'R', 1, 0, 0, 0,
+		0, 1, 0, 0, 0, 0, 0, 0, 0,
+	};
+	static const unsigned char truncated[] = {
+		'S', 'P', 'T', 'R', 1, 0, 0, 0,
+		1, 1, 0, 0, 0, 0, 0, 0, 0,
+		2, 1, 0, 0,
+	};
+	struct bench_trace_entry *entries;
+	size_t count;
+
+	test_trace_write_raw(bad_magic, sizeof(bad_magic));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	test_trace_write_raw(bad_version, sizeof(bad_version));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	test_trace_write_raw(short_header, sizeof(short_header));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	test_trace_write_raw(bad_op, sizeof(bad_op));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	test_trace_write_raw(no_op, sizeof(no_op));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	test_trace_write_raw(truncated, sizeof(truncated));
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+
+	remove(test_trace_path);
+	assert(bench_trace_load(test_trace_path, &entries, &count) < 0);
+}
+
+int main(void)
+{
+	test_trace_round_trip();
+	test_trace_empty();
+	test_trace_invalid();
+
+	return 0;
+}
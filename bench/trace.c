@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions benchmark - operation traces
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include "trace.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_TRACE_VERSION	1
+#define BENCH_TRACE_ENTRY_LEN	9
+
+static const unsigned char bench_trace_magic[4] = { 'S', 'P', 'T', 'R' };
+
+/**
+ * bench_trace_create() - Create new trace file for the recorder
+ * @path: path of the trace file
+ *
+ * Return: file to be used with bench_trace_record, NULL on errors
+ */
+FILE *bench_trace_create(const char *path)
+{
+	unsigned char header[8];
+	FILE *fp;
+
+	fp = fopen(path, "wb");
+	if (!fp)
+		return NULL;
+
+	memcpy(header, bench_trace_magic, sizeof(bench_trace_magic));
+	header[4] = BENCH_TRACE_VERSION;
+	header[5] = 0;
+	header[6] = 0;
+	header[7] = 0;
+
+	if (fwrite(header, sizeof(header), 1, fp) != 1) {
+		fclose(fp);
+		return NULL;
+	}
+
+	return fp;
+}
+
+/**
+ * bench_trace_record() - Append operation to trace
+ * @fp: trace file created with bench_trace_create
+ * @op: operation to record
+ * @key: key used by the operation
+ *
+ * The recorder is meant to be called next to the insert/find/erase calls of
+ * the application. The stdio buffering keeps the overhead small.
+ *
+ * Return: 0 on success, -1 on errors
+ */
+int bench_trace_record(FILE *fp, enum bench_trace_op op, uint64_t key)
+{
+	unsigned char buf[BENCH_TRACE_ENTRY_LEN];
+	size_t i;
+
+	buf[0] = (unsigned char)op;
+	for (i = 0; i < 8; i++)
+		buf[1 + i] = (unsigned char)(key >> (8 * i));
+
+	if (fwrite(buf, sizeof(buf), 1, fp) != 1)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * bench_trace_close() - Finish trace file
+ * @fp: trace file created with bench_trace_create
+ *
+ * Return: 0 on success, -1 on errors
+ */
+int bench_trace_close(FILE *fp)
+{
+	if (fclose(fp) != 0)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * bench_trace_load() - Load complete trace into memory
+ * @path: path of the trace file
+ * @entries: returns allocated array of entries (free'd by caller), NULL for
+ *  a trace without entries
+ * @count: returns number of loaded entries
+ *
+ * A trace with an invalid header, an unknown operation or a truncated entry
+ * is rejected.
+ *
+ * Return: 0 on success, -1 on errors
+ */
+int bench_trace_load(const char *path, struct bench_trace_entry **entries,
+		     size_t *count)
+{
+	unsigned char buf[BENCH_TRACE_ENTRY_LEN];
+	struct bench_trace_entry *loaded = NULL;
+	struct bench_trace_entry *tmp;
+	unsigned char header[8];
+	size_t allocated = 0;
+	size_t len = 0;
+	size_t read_len;
+	FILE *fp;
+	size_t i;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return -1;
+
+	if (fread(header, sizeof(header), 1, fp) != 1 ||
+	    memcmp(header, bench_trace_magic, sizeof(bench_trace_magic)) != 0 ||
+	    header[4] != BENCH_TRACE_VERSION || header[5] != 0 ||
+	    header[6] != 0 || header[7] != 0)
+		goto err;
+
+	while ((read_len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+		if (read_len != sizeof(buf))
+			goto err;
+
+		if (buf[0] < BENCH_TRACE_INSERT || buf[0] > BENCH_TRACE_POP_MIN)
+			goto err;
+
+		if (len == allocated) {
+			allocated = allocated ? 2 * allocated : 4096;
+			tmp = (struct bench_trace_entry *)realloc(loaded,
+								  allocated * sizeof(*loaded));
+			if (!tmp)
+				goto err;
+
+			loaded = tmp;
+		}
+
+		loaded[len].op = buf[0];
+		loaded[len].key = 0;
+		for (i = 8; i > 0; i--) {
+			loaded[len].key <<= 8;
+			loaded[len].key |= buf[i];
+		}
+		len++;
+	}
+
+	if (ferror(fp))
+		goto err;
+
+	fclose(fp);
+	*entries = loaded;
+	*count = len;
+
+	return 0;
+
+err:
+	free(loaded);
+	fclose(fp);
+	return -1;
+}
@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions benchmark - operation traces
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYTREE_BENCH_TRACE_H__
+#define __SPLAYTREE_BENCH_TRACE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * enum bench_trace_op - operation stored in a trace
+ * @BENCH_TRACE_INSERT: key was inserted
+ * @BENCH_TRACE_FIND: key was searched
+ * @BENCH_TRACE_ERASE: key was searched and removed
+ * @BENCH_TRACE_POP_MIN: smallest key was removed (key is ignored)
+ */
+enum bench_trace_op {
+	BENCH_TRACE_INSERT = 1,
+	BENCH_TRACE_FIND = 2,
+	BENCH_TRACE_ERASE = 3,
+	BENCH_TRACE_POP_MIN = 4
+};
+
+/**
+ * struct bench_trace_entry - single operation of a trace
+ * @op: enum bench_trace_op of the operation
+ * @key: key used by the operation
+ *
+ * A trace file starts with the magic "SPTR" and a little endian 32 bit format
+ * version (1). Each entry is stored as 1 byte operation followed by the
+ * little endian 64 bit key.
+ */
+struct bench_trace_entry {
+	uint8_t op;
+	uint64_t key;
+};
+
+FILE *bench_trace_create(const char *path);
+int bench_trace_record(FILE *fp, enum bench_trace_op op, uint64_t key);
+int bench_trace_close(FILE *fp);
+
+int bench_trace_load(const char *path, struct bench_trace_entry **entries,
+		     size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYTREE_BENCH_TRACE_H__ */
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions - bounded key/value cache
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include "splaycache.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaytree.h"
+
+/**
+ * splay_cache_init() - Initialize empty cache
+ * @cache: pointer to the cache
+ * @max_count: maximum number of entries, 0 for no limit
+ * @max_bytes: maximum sum of entry sizes, 0 for no limit
+ * @evict: callback for entries removed due to the limits, can be NULL
+ * @priv: private data for @evict
+ */
+void splay_cache_init(struct splay_cache *cache, size_t max_count,
+		      size_t max_bytes, splay_cache_evict_t evict, void *priv)
+{
+	INIT_SPLAY_U64_ROOT(&cache->root);
+	cache->mru = NULL;
+	cache->lru = NULL;
+	cache->count = 0;
+	cache->bytes = 0;
+	cache->max_count = max_count;
+	cache->max_bytes = max_bytes;
+	cache->evict = evict;
+	cache->priv = priv;
+}
+
+/**
+ * splay_cache_lru_unlink() - Remove entry from recency list
+ * @cache: pointer to the cache
+ * @entry: entry in the recency list of @cache
+ */
+static void splay_cache_lru_unlink(struct splay_cache *cache,
+				   struct splay_cache_entry *entry)
+{
+	if (entry->lru_prev)
+		entry->lru_prev->lru_next = entry->lru_next;
+	else
+		cache->mru = entry->lru_next;
+
+	if (entry->lru_next)
+		entry->lru_next->lru_prev = entry->lru_prev;
+	else
+		cache->lru = entry->lru_prev;
+}
+
+/**
+ * splay_cache_lru_push() - Add entry as most recently used entry
+ * @cache: pointer to the cache
+ * @entry: entry not in the recency list of @cache
+ */
+static void splay_cache_lru_push(struct splay_cache *cache,
+				 struct splay_cache_entry *entry)
+{
+	entry->lru_prev = NULL;
+	entry->lru_next = cache->mru;
+
+	if (cache->mru)
+		cache->mru->lru_prev = entry;
+	else
+		cache->lru = entry;
+
+	cache->mru = entry;
+}
+
+/**
+ * splay_cache_unlink() - Remove entry from tree, recency list and accounting
+ * @cache: pointer to the cache
+ * @entry: entry in @cache
+ *
+ * A cold entry can be deep in the tree, and the search for its successor walks
+ * even further down. The deepest node touched by the removal is therefore
+ * splayed afterwards, which bounds the removal to O(log n) amortized. The
+ * splay moves some cold neighbors of @entry up, but the next lookups of hot
+ * entries move these up again.
+ */
+static void splay_cache_unlink(struct splay_cache *cache,
+			       struct splay_cache_entry *entry)
+{
+	splay_u64_erase(&entry->node, &cache->root);
+	splay_cache_lru_unlink(cache, entry);
+
+	cache->count--;
+	cache->bytes -= entry->size;
+}
+
+/**
+ * splay_cache_over_limit() - Check if cache exceeds its limits
+ * @cache: pointer to the cache
+ *
+ * Return: true when number of entries or sum of sizes is too large
+ */
+static bool splay_cache_over_limit(const struct splay_cache *cache)
+{
+	if (cache->max_count && cache->count > cache->max_count)
+		return true;
+
+	if (cache->max_bytes && cache->bytes > cache->max_bytes)
+		return true;
+
+	return false;
+}
+
+/**
+ * splay_cache_shrink() - Evict least recently used entries until in limits
+ * @cache: pointer to the cache
+ * @keep: entry which must not be evicted, can be NULL
+ *
+ * Each victim is taken from the tail of the recency list in O(1) and removed
+ * from the tree in O(log n) amortized (see splay_cache_unlink()).
+ */
+static void splay_cache_shrink(struct splay_cache *cache,
+			       struct splay_cache_entry *keep)
+{
+	struct splay_cache_entry *entry;
+
+	while (splay_cache_over_limit(cache)) {
+		entry = cache->lru;
+		if (!entry || entry == keep)
+			break;
+
+		splay_cache_unlink(cache, entry);
+		if (cache->evict)
+			cache->evict(cache, entry, cache->priv);
+	}
+}
+
+/**
+ * splay_cache_lookup() - Search entry and mark it as most recently used
+ * @cache: pointer to the cache
+ * @key: key to search
+ *
+ * The found entry is splayed to the root of the tree. The last visited entry
+ * is splayed instead when @key is not in the cache.
+ *
+ * Return: entry with key @key, NULL if no such entry exists
+ */
+struct splay_cache_entry *splay_cache_lookup(struct splay_cache *cache,
+					     uint64_t key)
+{
+	struct splay_u64_node *node;
+	struct splay_cache_entry *entry;
+
+	node = splay_u64_find(&cache->root, key);
+	if (!node)
+		return NULL;
+
+	entry = container_of(node, struct splay_cache_entry, node);
+	if (cache->mru != entry) {
+		splay_cache_lru_unlink(cache, entry);
+		splay_cache_lru_push(cache, entry);
+	}
+
+	return entry;
+}
+
+/**
+ * splay_cache_insert() - Add new entry to cache
+ * @cache: pointer to the cache
+ * @entry: pointer to the new entry
+ * @key: key of the new entry
+ * @size: number of bytes charged to the cache for this entry
+ *
+ * The new entry is the most recently used entry. The least recently used
+ * entries are evicted (and given to the evict callback) until the cache is
+ * in its limits again. The new entry itself is never evicted by this
+ * function - even when its @size alone exceeds the byte limit.
+ *
+ * Return: 0 on success, -1 when an entry with @key is already in the cache
+ */
+int splay_cache_insert(struct splay_cache *cache,
+		       struct splay_cache_entry *entry, uint64_t key,
+		       size_t size)
+{
+	if (splay_u64_find(&cache->root, key))
+		return -1;
+
+	entry->node.key = key;
+	entry->size = size;
+
+	splay_u64_insert(&entry->node, &cache->root);
+	splay_cache_lru_push(cache, entry);
+
+	cache->count++;
+	cache->bytes += size;
+
+	splay_cache_shrink(cache, entry);
+
+	return 0;
+}
+
+/**
+ * splay_cache_remove() - Remove entry from cache
+ * @cache: pointer to the cache
+ * @entry: entry in @cache
+ *
+ * The evict callback is not called for @entry.
+ */
+void splay_cache_remove(struct splay_cache *cache,
+			struct splay_cache_entry *entry)
+{
+	splay_cache_unlink(cache, entry);
+}
+
+/**
+ * splay_cache_set_limits() - Change limits of cache
+ * @cache: pointer to the cache
+ * @max_count: maximum number of entries, 0 for no limit
+ * @max_bytes: maximum sum of entry sizes, 0 for no limit
+ *
+ * The least recently used entries are evicted until the cache is in the new
+ * limits.
+ */
+void splay_cache_set_limits(struct splay_cache *cache, size_t max_count,
+			    size_t max_bytes)
+{
+	cache->max_count = max_count;
+	cache->max_bytes = max_bytes;
+
+	splay_cache_shrink(cache, NULL);
+}
+
+/**
+ * splay_cache_clear() - Evict all entries of the cache
+ * @cache: pointer to the cache
+ *
+ * The entries are given to the evict callback from least to most recently
+ * used.
+ */
+void splay_cache_clear(struct splay_cache *cache)
+{
+	struct splay_cache_entry *entry;
+
+	while (cache->lru) {
+		entry = cache->lru;
+
+		splay_cache_unlink(cache, entry);
+		if (cache->evict)
+			cache->evict(cache, entry, cache->priv);
+	}
+}
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions - bounded key/value cache
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYCACHE_H__
+#define __SPLAYCACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaytree.h"
+
+struct splay_cache;
+
+/**
+ * struct splay_cache_entry - entry of a bounded cache
+ * @node: node in the cache tree, contains the key of the entry
+ * @lru_prev: next more recently used entry
+ * @lru_next: next less recently used entry
+ * @size: number of bytes charged to the cache for this entry
+ *
+ * The entry is embedded in the object which stores the cached value. The
+ * object can be retrieved with splay_entry.
+ */
+struct splay_cache_entry {
+	struct splay_u64_node node;
+	struct splay_cache_entry *lru_prev;
+	struct splay_cache_entry *lru_next;
+	size_t size;
+};
+
+/**
+ * typedef splay_cache_evict_t - callback for evicted cache entries
+ * @cache: cache from which @entry was evicted
+ * @entry: entry which is no longer part of @cache
+ * @priv: private data given to splay_cache_init
+ */
+typedef void (*splay_cache_evict_t)(struct splay_cache *cache,
+				    struct splay_cache_entry *entry,
+				    void *priv);
+
+/**
+ * struct splay_cache - bounded key/value cache
+ * @root: splay tree with all entries, ordered by key
+ * @mru: most recently used entry
+ * @lru: least recently used entry
+ * @count: number of entries in the cache
+ * @bytes: sum of the sizes of all entries in the cache
+ * @max_count: maximum number of entries, 0 for no limit
+ * @max_bytes: maximum sum of entry sizes, 0 for no limit
+ * @evict: callback for entries removed due to the limits, can be NULL
+ * @priv: private data for @evict
+ *
+ * A lookup splays the found entry to the root of the tree. Frequently used
+ * keys are therefore found after a short descent without an additional hash
+ * table. The entries are also kept in a recency list which is updated on each
+ * hit. The least recently used entries are evicted when an insert exceeds one
+ * of the limits. Selecting the victim from the recency list is O(1) and
+ * removing it from the tree is O(log n) amortized for n entries.
+ */
+struct splay_cache {
+	struct splay_u64_root root;
+	struct splay_cache_entry *mru;
+	struct splay_cache_entry *lru;
+	size_t count;
+	size_t bytes;
+	size_t max_count;
+	size_t max_bytes;
+	splay_cache_evict_t evict;
+	void *priv;
+};
+
+void splay_cache_init(struct splay_cache *cache, size_t max_count,
+		      size_t max_bytes, splay_cache_evict_t evict, void *priv);
+struct splay_cache_entry *splay_cache_lookup(struct splay_cache *cache,
+					     uint64_t key);
+int splay_cache_insert(struct splay_cache *cache,
+		       struct splay_cache_entry *entry, uint64_t key,
+		       size_t size);
+void splay_cache_remove(struct splay_cache *cache,
+			struct splay_cache_entry *entry);
+void splay_cache_set_limits(struct splay_cache *cache, size_t max_count,
+			    size_t max_bytes);
+void splay_cache_clear(struct splay_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYCACHE_H__ */
@@ -0,0 +1,786 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions - multithreaded bulk operations
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include "splayparallel.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "splaytree.h"
+
+/**
+ * struct splay_parallel_job - work item executed by a worker thread
+ * @func: function which executes the work item
+ * @thread: worker thread which runs @func
+ * @started: true when @thread was created, false when @func already ran in
+ *  the calling thread
+ *
+ * The job is embedded in the operation specific work item. The work item can
+ * be retrieved with container_of in @func.
+ */
+struct splay_parallel_job {
+	void (*func)(struct splay_parallel_job *job);
+	pthread_t thread;
+	bool started;
+};
+
+/**
+ * struct splay_parallel_sort - work item to sort or merge nodes
+ * @job: embedded job
+ * @nodes: nodes to sort
+ * @tmp: scratch buffer with the same size as @nodes
+ * @count: number of nodes in @nodes
+ * @mid: number of already sorted nodes in the first half for a merge, 0 to
+ *  sort all nodes
+ * @cmp: comparison function between two nodes
+ * @priv: private data for @cmp
+ */
+struct splay_parallel_sort {
+	struct splay_parallel_job job;
+	struct splay_node **nodes;
+	struct splay_node **tmp;
+	size_t count;
+	size_t mid;
+	splay_parallel_cmp_t cmp;
+	void *priv;
+};
+
+/**
+ * struct splay_parallel_link - work item to link a balanced subtree
+ * @job: embedded job
+ * @nodes: sorted nodes of the subtree
+ * @count: number of nodes in @nodes
+ * @parent: parent node of the subtree
+ * @link: pointer to the left/right pointer of @parent which receives the
+ *  root of the subtree
+ */
+struct splay_parallel_link {
+	struct splay_parallel_job job;
+	struct splay_node **nodes;
+	size_t count;
+	struct splay_node *parent;
+	struct splay_node **link;
+};
+
+/**
+ * struct splay_parallel_scan_task - part of the tree visited by a worker
+ * @node: node to visit
+ * @subtree: true to visit the whole subtree below @node, false to only visit
+ *  @node itself
+ */
+struct splay_parallel_scan_task {
+	struct splay_node *node;
+	bool subtree;
+};
+
+/**
+ * struct splay_parallel_scan - worker which visits parts of the tree
+ * @job: embedded job
+ * @tasks: parts of the tree shared by all workers
+ * @count: number of entries in @tasks
+ * @next: index of next unclaimed entry in @tasks, shared by all workers
+ * @lock: lock for @next, shared by all workers
+ * @func: callback for each visited node
+ * @priv: private data for @func
+ */
+struct splay_parallel_scan {
+	struct splay_parallel_job job;
+	const struct splay_parallel_scan_task *tasks;
+	size_t count;
+	size_t *next;
+	pthread_mutex_t *lock;
+	void (*func)(struct splay_node *node, void *priv);
+	void *priv;
+};
+
+/**
+ * struct splay_parallel_set - work item for set operation on key range
+ * @job: embedded job
+ * @root: nodes of the first tree in the key range, receives the result
+ * @other: nodes of the second tree in the key range, receives the remaining
+ *  nodes
+ * @op: set operation
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ */
+struct splay_parallel_set {
+	struct splay_parallel_job job;
+	struct splay_root root;
+	struct splay_root other;
+	enum splay_set_op op;
+	int (*cmp)(const void *key, const struct splay_node *node);
+};
+
+/**
+ * splay_parallel_thread() - Entry point of worker thread
+ * @arg: pointer to struct splay_parallel_job
+ *
+ * Return: always NULL
+ */
+static void *splay_parallel_thread(void *arg)
+{
+	struct splay_parallel_job *job = (struct splay_parallel_job *)arg;
+
+	job->func(job);
+
+	return NULL;
+}
+
+/**
+ * splay_parallel_run() - Execute jobs concurrently and wait for them
+ * @jobs: jobs to execute
+ * @count: number of jobs in @jobs
+ *
+ * The first job is executed by the calling thread. A job is also executed by
+ * the calling thread when no worker thread could be created for it.
+ */
+static void splay_parallel_run(struct splay_parallel_job **jobs, size_t count)
+{
+	struct splay_parallel_job *job;
+	size_t i;
+
+	for (i = 1; i < count; i++) {
+		job = jobs[i];
+
+		job->started = !pthread_create(&job->thread, NULL,
+					       splay_parallel_thread, job);
+		if (!job->started)
+			job->func(job);
+	}
+
+	if (count)
+		jobs[0]->func(jobs[0]);
+
+	for (i = 1; i < count; i++) {
+		if (jobs[i]->started)
+			pthread_join(jobs[i]->thread, NULL);
+	}
+}
+
+/**
+ * splay_parallel_merge() - Merge two sorted halves of array
+ * @nodes: nodes with two sorted halves
+ * @mid: number of nodes in the first half
+ * @count: number of nodes in @nodes
+ * @tmp: scratch buffer for at least @count nodes
+ * @cmp: comparison function between two nodes
+ * @priv: private data for @cmp
+ *
+ * Equal nodes of the first half stay in front of the ones of the second half.
+ */
+static void splay_parallel_merge(struct splay_node **nodes, size_t mid,
+				 size_t count, struct splay_node **tmp,
+				 splay_parallel_cmp_t cmp, void *priv)
+{
+	size_t i = 0;
+	size_t j = mid;
+	size_t k = 0;
+
+	while (i < mid && j < count) {
+		if (cmp(nodes[j], nodes[i], priv) < 0)
+			tmp[k++] = nodes[j++];
+		else
+			tmp[k++] = nodes[i++];
+	}
+
+	while (i < mid)
+		tmp[k++] = nodes[i++];
+
+	/* remaining nodes of second half are already at the right place */
+	memcpy(nodes, tmp, k * sizeof(*nodes));
+}
+
+/**
+ * splay_parallel_msort() - Stable merge sort of nodes
+ * @nodes: nodes to sort
+ * @tmp: scratch buffer for at least @count nodes
+ * @count: number of nodes in @nodes
+ * @cmp: comparison function between two nodes
+ * @priv: private data for @cmp
+ */
+static void splay_parallel_msort(struct splay_node **nodes,
+				 struct splay_node **tmp, size_t count,
+				 splay_parallel_cmp_t cmp, void *priv)
+{
+	struct splay_node *node;
+	size_t mid;
+	size_t i, j;
+
+	if (count <= 8) {
+		for (i = 1; i < count; i++) {
+			node = nodes[i];
+
+			for (j = i; j > 0; j--) {
+				if (cmp(node, nodes[j - 1], priv) >= 0)
+					break;
+
+				nodes[j] = nodes[j - 1];
+			}
+
+			nodes[j] = node;
+		}
+
+		return;
+	}
+
+	mid = count / 2;
+	splay_parallel_msort(nodes, tmp, mid, cmp, priv);
+	splay_parallel_msort(&nodes[mid], &tmp[mid], count - mid, cmp, priv);
+
+	/* halves are already in order */
+	if (cmp(nodes[mid], nodes[mid - 1], priv) >= 0)
+		return;
+
+	splay_parallel_merge(nodes, mid, count, tmp, cmp, priv);
+}
+
+/**
+ * splay_parallel_sort_job() - Sort or merge nodes of work item
+ * @job: job embedded in struct splay_parallel_sort
+ */
+static void splay_parallel_sort_job(struct splay_parallel_job *job)
+{
+	struct splay_parallel_sort *sort;
+
+	sort = container_of(job, struct splay_parallel_sort, job);
+
+	if (sort->mid)
+		splay_parallel_merge(sort->nodes, sort->mid, sort->count,
+				     sort->tmp, sort->cmp, sort->priv);
+	else
+		splay_parallel_msort(sort->nodes, sort->tmp, sort->count,
+				     sort->cmp, sort->priv);
+}
+
+/**
+ * splay_parallel_link_range() - Link sorted nodes as balanced subtree
+ * @nodes: sorted nodes of the subtree
+ * @count: number of nodes in @nodes
+ * @parent: parent node of the subtree
+ *
+ * Return: root of the subtree, NULL when @count is 0
+ */
+static struct splay_node *
+splay_parallel_link_range(struct splay_node **nodes, size_t count,
+			  struct splay_node *parent)
+{
+	struct splay_node *node;
+	size_t mid;
+
+	if (!count)
+		return NULL;
+
+	mid = count / 2;
+	node = nodes[mid];
+	node->parent = parent;
+	node->left = splay_parallel_link_range(nodes, mid, node);
+	node->right = splay_parallel_link_range(&nodes[mid + 1],
+						count - mid - 1, node);
+
+	return node;
+}
+
+/**
+ * splay_parallel_link_job() - Link balanced subtree of work item
+ * @job: job embedded in struct splay_parallel_link
+ */
+static void splay_parallel_link_job(struct splay_parallel_job *job)
+{
+	struct splay_parallel_link *link;
+
+	link = container_of(job, struct splay_parallel_link, job);
+
+	*link->link = splay_parallel_link_range(link->nodes, link->count,
+						link->parent);
+}
+
+/**
+ * splay_parallel_link_top() - Link top levels and queue lower subtrees
+ * @nodes: sorted nodes of the subtree
+ * @count: number of nodes in @nodes
+ * @parent: parent node of the subtree
+ * @link: pointer to the left/right pointer of @parent
+ * @depth: number of levels which are still linked by the calling thread
+ * @links: array which receives the work items for the lower subtrees
+ * @used: number of already used entries in @links
+ */
+static void splay_parallel_link_top(struct splay_node **nodes, size_t count,
+				    struct splay_node *parent,
+				    struct splay_node **link,
+				    unsigned int depth,
+				    struct splay_parallel_link *links,
+				    size_t *used)
+{
+	struct splay_parallel_link *item;
+	struct splay_node *node;
+	size_t mid;
+
+	if (!depth || !count) {
+		item = &links[(*used)++];
+		item->job.func = splay_parallel_link_job;
+		item->nodes = nodes;
+		item->count = count;
+		item->parent = parent;
+		item->link = link;
+		return;
+	}
+
+	mid = count / 2;
+	node = nodes[mid];
+	node->parent = parent;
+	*link = node;
+
+	splay_parallel_link_top(nodes, mid, node, &node->left, depth - 1,
+				links, used);
+	splay_parallel_link_top(&nodes[mid + 1], count - mid - 1, node,
+				&node->right, depth - 1, links, used);
+}
+
+/**
+ * splay_parallel_build() - Build balanced tree from unsorted nodes
+ * @root: pointer to splay root which receives the tree
+ * @nodes: unsorted nodes of the new tree, sorted afterwards
+ * @count: number of nodes in @nodes
+ * @cmp: comparison function between two nodes
+ * @priv: private data for @cmp
+ * @threads: maximum number of threads (including the calling one) to use, 0
+ *  is handled like 1
+ *
+ * The nodes are sorted by a stable merge sort. Each thread first sorts its
+ * own chunk of @nodes and the chunks are then merged pairwise in parallel.
+ * The balanced tree is linked afterwards: the calling thread links the top
+ * levels and each of the subtrees below them is linked by its own thread.
+ * Equal nodes keep the order in which they are stored in @nodes.
+ *
+ * The previous content of @root is discarded. The nodes of @root are not
+ * touched when the function fails.
+ *
+ * Return: 0 on success, -1 when the scratch memory could not be allocated
+ */
+int splay_parallel_build(struct splay_root *root, struct splay_node **nodes,
+			 size_t count, splay_parallel_cmp_t cmp, void *priv,
+			 unsigned int threads)
+{
+	struct splay_parallel_sort *sorts = NULL;
+	struct splay_parallel_link *links = NULL;
+	struct splay_parallel_job **jobs = NULL;
+	struct splay_node **tmp = NULL;
+	unsigned int depth = 0;
+	size_t njobs;
+	size_t chunks;
+	size_t used;
+	size_t step;
+	size_t mid;
+	size_t end;
+	size_t i;
+	int ret = -1;
+
+	if (!count) {
+		root->node = NULL;
+		return 0;
+	}
+
+	chunks = threads;
+	if (chunks > count)
+		chunks = count;
+	if (!chunks)
+		chunks = 1;
+
+	while (((size_t)1 << depth) < chunks)
+		depth++;
+
+	njobs = (size_t)1 << depth;
+	if (njobs < chunks)
+		njobs = chunks;
+
+	tmp = (struct splay_node **)malloc(count * sizeof(*tmp));
+	sorts = (struct splay_parallel_sort *)malloc(chunks * sizeof(*sorts));
+	links = (struct splay_parallel_link *)malloc(((size_t)1 << depth) *
+						     sizeof(*links));
+	jobs = (struct splay_parallel_job **)malloc(njobs * sizeof(*jobs));
+	if (!tmp || !sorts || !links || !jobs)
+		goto out;
+
+	/* sort each chunk in its own thread */
+	for (i = 0; i < chunks; i++) {
+		sorts[i].job.func = splay_parallel_sort_job;
+		sorts[i].nodes = &nodes[count * i / chunks];
+		sorts[i].tmp = &tmp[count * i / chunks];
+		sorts[i].count = count * (i + 1) / chunks - count * i / chunks;
+		sorts[i].mid = 0;
+		sorts[i].cmp = cmp;
+		sorts[i].priv = priv;
+		jobs[i] = &sorts[i].job;
+	}
+	splay_parallel_run(jobs, chunks);
+
+	/* merge neighbor chunks pairwise until only one is left */
+	for (step = 1; step < chunks; step *= 2) {
+		used = 0;
+
+		for (i = 0; i + step < chunks; i += 2 * step) {
+			mid = count * (i + step) / chunks;
+			end = i + 2 * step;
+			if (end > chunks)
+				end = chunks;
+			end = count * end / chunks;
+
+			sorts[used].nodes = &nodes[count * i / chunks];
+			sorts[used].tmp = &tmp[count * i / chunks];
+			sorts[used].count = end - count * i / chunks;
+			sorts[used].mid = mid - count * i / chunks;
+			jobs[used] = &sorts[used].job;
+			used++;
+		}
+
+		splay_parallel_run(jobs, used);
+	}
+
+	/* link subtrees below the top levels in parallel */
+	root->node = NULL;
+	used = 0;
+	splay_parallel_link_top(nodes, count, NULL, &root->node, depth, links,
+				&used);
+	for (i = 0; i < used; i++)
+		jobs[i] = &links[i].job;
+	splay_parallel_run(jobs, used);
+
+	ret = 0;
+
+out:
+	free(jobs);
+	free(links);
+	free(sorts);
+	free(tmp);
+
+	return ret;
+}
+
+/**
+ * splay_parallel_scan_top() - Split top levels of tree into scan tasks
+ * @node: root of the subtree to split
+ * @depth: number of levels which are still split into single nodes
+ * @tasks: array which receives the scan tasks in-order
+ * @used: number of already used entries in @tasks
+ */
+static void splay_parallel_scan_top(struct splay_node *node,
+				    unsigned int depth,
+				    struct splay_parallel_scan_task *tasks,
+				    size_t *used)
+{
+	struct splay_parallel_scan_task *task;
+
+	if (!node)
+		return;
+
+	if (!depth) {
+		task = &tasks[(*used)++];
+		task->node = node;
+		task->subtree = true;
+		return;
+	}
+
+	splay_parallel_scan_top(node->left, depth - 1, tasks, used);
+
+	task = &tasks[(*used)++];
+	task->node = node;
+	task->subtree = false;
+
+	splay_parallel_scan_top(node->right, depth - 1, tasks, used);
+}
+
+/**
+ * splay_parallel_scan_subtree() - Visit all nodes of subtree in-order
+ * @top: root of the subtree
+ * @func: callback for each visited node
+ * @priv: private data for @func
+ *
+ * The subtree is walked via the parent pointers. It is neither modified nor
+ * splayed.
+ */
+static void
+splay_parallel_scan_subtree(struct splay_node *top,
+			    void (*func)(struct splay_node *node, void *priv),
+			    void *priv)
+{
+	struct splay_node *node = top;
+
+	while (node->left)
+		node = node->left;
+
+	while (1) {
+		func(node, priv);
+
+		if (node->right) {
+			node = node->right;
+			while (node->left)
+				node = node->left;
+
+			continue;
+		}
+
+		while (node != top && node->parent->right == node)
+			node = node->parent;
+
+		if (node == top)
+			break;
+
+		node = node->parent;
+	}
+}
+
+/**
+ * splay_parallel_scan_job() - Visit scan tasks until all are claimed
+ * @job: job embedded in struct splay_parallel_scan
+ */
+static void splay_parallel_scan_job(struct splay_parallel_job *job)
+{
+	const struct splay_parallel_scan_task *task;
+	struct splay_parallel_scan *scan;
+	size_t index;
+
+	scan = container_of(job, struct splay_parallel_scan, job);
+
+	while (1) {
+		pthread_mutex_lock(scan->lock);
+		index = (*scan->next)++;
+		pthread_mutex_unlock(scan->lock);
+
+		if (index >= scan->count)
+			break;
+
+		task = &scan->tasks[index];
+		if (task->subtree)
+			splay_parallel_scan_subtree(task->node, scan->func,
+						    scan->priv);
+		else
+			scan->func(task->node, scan->priv);
+	}
+}
+
+/**
+ * splay_parallel_for_each() - Call function for each node using threads
+ * @root: pointer to splay root
+ * @func: callback for each node
+ * @priv: private data for @func
+ * @threads: maximum number of threads (including the calling one) to use, 0
+ *  is handled like 1
+ *
+ * The top levels of the tree are split into single nodes and the disjoint
+ * subtrees below them. The threads claim these parts one after another and
+ * walk them without splaying. Several parts per thread are created so that
+ * threads which got small subtrees can continue with further parts. A
+ * degenerated tree with a single long path is not split evenly and should be
+ * rebalanced first.
+ *
+ * @func is called concurrently from multiple threads and in no particular
+ * order. The tree must not be modified until the function returns.
+ *
+ * Return: 0 on success, -1 when the scratch memory could not be allocated
+ */
+int splay_parallel_for_each(const struct splay_root *root,
+			    void (*func)(struct splay_node *node, void *priv),
+			    void *priv, unsigned int threads)
+{
+	struct splay_parallel_scan_task *tasks = NULL;
+	struct splay_parallel_scan *scans = NULL;
+	struct splay_parallel_job **jobs = NULL;
+	pthread_mutex_t lock;
+	unsigned int depth = 0;
+	size_t next = 0;
+	size_t used = 0;
+	size_t i;
+	int ret = -1;
+
+	if (!root->node)
+		return 0;
+
+	if (!threads)
+		threads = 1;
+
+	/* around 8 subtrees per thread */
+	while (((size_t)1 << depth) < threads)
+		depth++;
+	depth += 3;
+
+	tasks = (struct splay_parallel_scan_task *)
+		malloc((((size_t)1 << (depth + 1)) - 1) * sizeof(*tasks));
+	scans = (struct splay_parallel_scan *)malloc(threads *
+						     sizeof(*scans));
+	jobs = (struct splay_parallel_job **)malloc(threads * sizeof(*jobs));
+	if (!tasks || !scans || !jobs)
+		goto out;
+
+	if (pthread_mutex_init(&lock, NULL))
+		goto out;
+
+	splay_parallel_scan_top(root->node, depth, tasks, &used);
+	if (threads > used)
+		threads = (unsigned int)used;
+
+	for (i = 0; i < threads; i++) {
+		scans[i].job.func = splay_parallel_scan_job;
+		scans[i].tasks = tasks;
+		scans[i].count = used;
+		scans[i].next = &next;
+		scans[i].lock = &lock;
+		scans[i].func = func;
+		scans[i].priv = priv;
+		jobs[i] = &scans[i].job;
+	}
+	splay_parallel_run(jobs, threads);
+
+	pthread_mutex_destroy(&lock);
+	ret = 0;
+
+out:
+	free(jobs);
+	free(scans);
+	free(tasks);
+
+	return ret;
+}
+
+/**
+ * splay_parallel_set_pivots() - Collect top levels of tree in-order
+ * @node: root of the subtree
+ * @depth: number of levels which are still collected
+ * @pivots: array which receives the nodes in-order
+ * @used: number of already used entries in @pivots
+ */
+static void splay_parallel_set_pivots(struct splay_node *node,
+				      unsigned int depth,
+				      struct splay_node **pivots,
+				      size_t *used)
+{
+	if (!node || !depth)
+		return;
+
+	splay_parallel_set_pivots(node->left, depth - 1, pivots, used);
+	pivots[(*used)++] = node;
+	splay_parallel_set_pivots(node->right, depth - 1, pivots, used);
+}
+
+/**
+ * splay_parallel_set_job() - Run set operation of work item
+ * @job: job embedded in struct splay_parallel_set
+ */
+static void splay_parallel_set_job(struct splay_parallel_job *job)
+{
+	struct splay_parallel_set *set;
+
+	set = container_of(job, struct splay_parallel_set, job);
+
+	splay_set_operation(&set->root, &set->other, set->op, set->cmp);
+}
+
+/**
+ * splay_parallel_set_operation() - Combine two trees using threads
+ * @root: pointer to splay root of the first tree, receives the result
+ * @other: pointer to splay root of the second tree, receives the remaining
+ *  nodes
+ * @op: set operation
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root or @other
+ * @threads: maximum number of threads (including the calling one) to use, 0
+ *  is handled like 1
+ *
+ * @other is first rebuilt by splay_rebalance. The nodes in its top levels are
+ * then used as pivots which divide it into ranges of similar size. Both trees
+ * are split at each pivot into disjoint key ranges. The key ranges between the
+ * pivots are processed by splay_set_operation in their own threads and the
+ * results are joined again in order. The result is the same as the one of
+ * splay_set_operation.
+ *
+ * Return: 0 on success, -1 when the scratch memory could not be allocated
+ */
+int splay_parallel_set_operation(struct splay_root *root,
+				 struct splay_root *other,
+				 enum splay_set_op op,
+				 int (*cmp)(const void *key,
+					    const struct splay_node *node),
+				 unsigned int threads)
+{
+	struct splay_parallel_set *sets = NULL;
+	struct splay_parallel_job **jobs = NULL;
+	struct splay_node **pivots = NULL;
+	unsigned int depth = 0;
+	size_t used = 0;
+	size_t i;
+	int ret = -1;
+
+	if (threads <= 1 || !root->node || !other->node) {
+		splay_set_operation(root, other, op, cmp);
+		return 0;
+	}
+
+	while (((size_t)1 << depth) < threads)
+		depth++;
+
+	pivots = (struct splay_node **)malloc((((size_t)1 << depth) - 1) *
+					      sizeof(*pivots));
+	sets = (struct splay_parallel_set *)malloc(((size_t)1 << (depth + 1)) *
+						   sizeof(*sets));
+	jobs = (struct splay_parallel_job **)malloc(((size_t)1 << depth) *
+						    sizeof(*jobs));
+	if (!pivots || !sets || !jobs)
+		goto out;
+
+	splay_rebalance(other);
+	splay_parallel_set_pivots(other->node, depth, pivots, &used);
+
+	for (i = 0; i < 2 * used + 1; i++) {
+		sets[i].job.func = splay_parallel_set_job;
+		INIT_SPLAY_ROOT(&sets[i].root);
+		INIT_SPLAY_ROOT(&sets[i].other);
+		sets[i].op = op;
+		sets[i].cmp = cmp;
+	}
+
+	/* key range after pivot i is stored in 2 * i + 2, pivot in 2 * i + 1 */
+	for (i = used; i > 0; i--) {
+		splay_split(other, pivots[i - 1], cmp, &sets[2 * i].other);
+		sets[2 * i - 1].other.node = pivots[i - 1];
+
+		sets[2 * i - 1].root.node = splay_split(root, pivots[i - 1],
+							cmp, &sets[2 * i].root);
+	}
+
+	/* only the nodes are moved, the statistics stay in the caller's roots */
+	sets[0].root.node = root->node;
+	sets[0].other.node = other->node;
+	root->node = NULL;
+	other->node = NULL;
+
+	/* single pivot nodes are cheap and not worth a thread */
+	for (i = 0; i < used; i++) {
+		splay_parallel_set_job(&sets[2 * i + 1].job);
+		jobs[i] = &sets[2 * i].job;
+	}
+	jobs[used] = &sets[2 * used].job;
+	splay_parallel_run(jobs, used + 1);
+
+	for (i = 0; i < 2 * used + 1; i++) {
+		splay_join(root, NULL, &sets[i].root);
+		splay_join(other, NULL, &sets[i].other);
+#ifdef SPLAYTREE_STATS
+		splay_stats_merge(root, &sets[i].root);
+		splay_stats_merge(other, &sets[i].other);
+#endif
+	}
+
+	ret = 0;
+
+out:
+	free(jobs);
+	free(sets);
+	free(pivots);
+
+	return ret;
+}
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions - multithreaded bulk operations
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYPARALLEL_H__
+#define __SPLAYPARALLEL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "splaytree.h"
+
+/**
+ * typedef splay_parallel_cmp_t - comparison function between two nodes
+ * @node1: first node
+ * @node2: second node
+ * @priv: private data of the bulk operation
+ *
+ * The function is called concurrently from multiple threads. It must
+ * therefore not modify shared state without its own locking.
+ *
+ * Return: negative value when the entry of @node1 is smaller, 0 when it is
+ *  equal and a positive value when it is larger than the entry of @node2
+ */
+typedef int (*splay_parallel_cmp_t)(const struct splay_node *node1,
+				    const struct splay_node *node2,
+				    void *priv);
+
+int splay_parallel_build(struct splay_root *root, struct splay_node **nodes,
+			 size_t count, splay_parallel_cmp_t cmp, void *priv,
+			 unsigned int threads);
+int splay_parallel_for_each(const struct splay_root *root,
+			    void (*func)(struct splay_node *node, void *priv),
+			    void *priv, unsigned int threads);
+int splay_parallel_set_operation(struct splay_root *root,
+				 struct splay_root *other,
+				 enum splay_set_op op,
+				 int (*cmp)(const void *key,
+					    const struct splay_node *node),
+				 unsigned int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYPARALLEL_H__ */
@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions - entry pool allocator
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "splaypool.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#define SPLAY_POOL_CACHELINE		64
+#define SPLAY_POOL_DEFAULT_SLAB		(64 * 1024)
+#define SPLAY_POOL_HUGEPAGE_SIZE	(2 * 1024 * 1024)
+
+/**
+ * struct splay_pool_slab - header at the beginning of each slab
+ * @next: next slab in the list of slabs of the pool
+ * @size: size of the slab including the header
+ * @mapped: slab was allocated with mmap instead of malloc
+ */
+struct splay_pool_slab {
+	struct splay_pool_slab *next;
+	size_t size;
+	bool mapped;
+};
+
+/**
+ * struct splay_pool_align - helper to calculate alignment of objects
+ * @c: padding to force alignment of @u
+ * @u: union of types with largest alignment requirements of an entry
+ *
+ * The alignment must be a power of two and not larger than
+ * SPLAY_POOL_CACHELINE because the objects start at a cache aligned offset.
+ */
+struct splay_pool_align {
+	char c;
+	union {
+		void *p;
+		double d;
+		long double ld;
+		long l;
+		size_t s;
+#if defined(__SIZEOF_INT128__)
+		__extension__ __int128 i128;
+#endif
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+		max_align_t m;
+#endif
+	} u;
+};
+
+/**
+ * splay_pool_round_up() - Round size up to next multiple of alignment
+ * @size: size to round up
+ * @align: alignment (power of two)
+ *
+ * Return: @size rounded up to multiple of @align
+ */
+static size_t splay_pool_round_up(size_t size, size_t align)
+{
+	return (size + align - 1) & ~(align - 1);
+}
+
+/**
+ * splay_pool_init() - Initialize empty pool
+ * @pool: pointer to pool
+ * @obj_size: size of the objects (entries) allocated from the pool
+ * @slab_size: size of the slabs requested from the system, 0 for default
+ * @flags: bitmask of SPLAY_POOL_* flags
+ *
+ * No memory is allocated before the first call of splay_pool_alloc.
+ */
+void splay_pool_init(struct splay_pool *pool, size_t obj_size,
+		     size_t slab_size, unsigned int flags)
+{
+	size_t align = offsetof(struct splay_pool_align, u);
+	size_t min_slab;
+
+	if (obj_size < sizeof(void *))
+		obj_size = sizeof(void *);
+	obj_size = splay_pool_round_up(obj_size, align);
+
+	if (!slab_size)
+		slab_size = SPLAY_POOL_DEFAULT_SLAB;
+
+	/* at least one object must fit behind the cache aligned header */
+	min_slab = 2 * SPLAY_POOL_CACHELINE + obj_size;
+	if (slab_size < min_slab)
+		slab_size = min_slab;
+
+	if (flags & SPLAY_POOL_HUGEPAGES)
+		slab_size = splay_pool_round_up(slab_size,
+						SPLAY_POOL_HUGEPAGE_SIZE);
+
+	pool->obj_size = obj_size;
+	pool->slab_size = slab_size;
+	pool->flags = flags;
+	pool->free_list = NULL;
+	pool->bump = NULL;
+	pool->bump_end = NULL;
+	pool->slabs = NULL;
+}
+
+/**
+ * splay_pool_slab_map() - Allocate slab memory backed by huge pages
+ * @size: size of the slab, multiple of SPLAY_POOL_HUGEPAGE_SIZE
+ *
+ * Reserved huge pages (MAP_HUGETLB) are used when available. Otherwise, the
+ * slab is mapped with normal pages and marked for transparent huge pages. A
+ * mapping is only page aligned and would usually straddle two huge page
+ * frames which could then not be backed by huge pages. The mapping is
+ * therefore one huge page larger than needed and the unaligned head and tail
+ * are unmapped again.
+ *
+ * Return: pointer to slab memory, NULL on errors
+ */
+static void *splay_pool_slab_map(size_t size)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+	void *mem = MAP_FAILED;
+	uintptr_t start;
+	uintptr_t aligned;
+	size_t head;
+	size_t tail;
+
+#if defined(MAP_HUGETLB)
+	mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+	if (mem != MAP_FAILED)
+		return mem;
+
+	/* no reserved huge pages - try transparent huge pages */
+	mem = mmap(NULL, size + SPLAY_POOL_HUGEPAGE_SIZE,
+		   PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+		return NULL;
+
+	start = (uintptr_t)mem;
+	aligned = (start + SPLAY_POOL_HUGEPAGE_SIZE - 1) &
+		  ~(uintptr_t)(SPLAY_POOL_HUGEPAGE_SIZE - 1);
+	head = (size_t)(aligned - start);
+	tail = SPLAY_POOL_HUGEPAGE_SIZE - head;
+
+	if (head)
+		munmap(mem, head);
+	if (tail)
+		munmap((void *)(aligned + size), tail);
+
+	mem = (void *)aligned;
+#if defined(MADV_HUGEPAGE)
+	madvise(mem, size, MADV_HUGEPAGE);
+#endif
+
+	return mem;
+#else
+	(void)size;
+
+	return NULL;
+#endif
+}
+
+/**
+ * splay_pool_slab_unmap() - Free slab memory allocated by splay_pool_slab_map
+ * @mem: pointer to slab memory
+ * @size: size of the slab
+ */
+static void splay_pool_slab_unmap(void *mem, size_t size)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+	munmap(mem, size);
+#else
+	(void)mem;
+	(void)size;
+#endif
+}
+
+/**
+ * splay_pool_grow() - Add new slab to pool
+ * @pool: pointer to pool
+ *
+ * Return: true when new slab was added, false on allocation errors
+ */
+static bool splay_pool_grow(struct splay_pool *pool)
+{
+	struct splay_pool_slab *slab;
+	bool mapped = false;
+	void *mem = NULL;
+	size_t offset;
+
+	if (pool->flags & SPLAY_POOL_HUGEPAGES) {
+		mem = splay_pool_slab_map(pool->slab_size);
+		if (mem)
+			mapped = true;
+	}
+
+	if (!mem)
+		mem = malloc(pool->slab_size);
+
+	if (!mem)
+		return false;
+
+	slab = (struct splay_pool_slab *)mem;
+	slab->size = pool->slab_size;
+	slab->mapped = mapped;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+
+	/* objects start at the first cache line after the header */
+	offset = (size_t)((uintptr_t)mem % SPLAY_POOL_CACHELINE);
+	offset = splay_pool_round_up(offset + sizeof(*slab),
+				     SPLAY_POOL_CACHELINE) - offset;
+
+	pool->bump = (char *)mem + offset;
+	pool->bump_end = (char *)mem + pool->slab_size;
+
+	return true;
+}
+
+/**
+ * splay_pool_alloc() - Allocate object from pool
+ * @pool: pointer to pool
+ *
+ * The last free'd object is returned first. New objects are otherwise
+ * allocated consecutively from the newest slab.
+ *
+ * Return: pointer to uninitialized object, NULL on allocation errors
+ */
+void *splay_pool_alloc(struct splay_pool *pool)
+{
+	void *obj;
+
+	if (pool->free_list) {
+		obj = pool->free_list;
+		pool->free_list = *(void **)obj;
+
+		return obj;
+	}
+
+	if (!pool->bump ||
+	    (size_t)(pool->bump_end - pool->bump) < pool->obj_size) {
+		if (!splay_pool_grow(pool))
+			return NULL;
+	}
+
+	obj = pool->bump;
+	pool->bump += pool->obj_size;
+
+	return obj;
+}
+
+/**
+ * splay_pool_free() - Return object to pool
+ * @pool: pointer to pool
+ * @obj: pointer to object allocated by splay_pool_alloc of @pool
+ *
+ * The memory isn't returned to the system before splay_pool_free_all is
+ * called.
+ */
+void splay_pool_free(struct splay_pool *pool, void *obj)
+{
+	*(void **)obj = pool->free_list;
+	pool->free_list = obj;
+}
+
+/**
+ * splay_pool_free_all() - Free all objects of the pool at once
+ * @pool: pointer to pool
+ *
+ * All slabs are returned to the system. All objects allocated from the pool
+ * become invalid - including the ones which are still part of a tree. The
+ * tree must therefore be discarded (reinitialized via INIT_SPLAY_ROOT) at the
+ * same time. This is much cheaper than erasing and freeing each entry.
+ *
+ * The pool can be used again afterwards.
+ */
+void splay_pool_free_all(struct splay_pool *pool)
+{
+	struct splay_pool_slab *slab;
+
+	while (pool->slabs) {
+		slab = pool->slabs;
+		pool->slabs = slab->next;
+
+		if (slab->mapped)
+			splay_pool_slab_unmap(slab, slab->size);
+		else
+			free(slab);
+	}
+
+	pool->free_list = NULL;
+	pool->bump = NULL;
+	pool->bump_end = NULL;
+}
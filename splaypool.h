@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions - entry pool allocator
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYPOOL_H__
+#define __SPLAYPOOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/**
+ * SPLAY_POOL_HUGEPAGES - back slabs with huge pages when possible
+ *
+ * The slab size is rounded up to 2 MiB. Slabs fall back to normal pages (with
+ * transparent huge page hint) when no huge page could be reserved.
+ */
+#define SPLAY_POOL_HUGEPAGES	0x1
+
+struct splay_pool_slab;
+
+/**
+ * struct splay_pool - pool of fixed size entries
+ * @obj_size: size of each object (rounded up to required alignment)
+ * @slab_size: size of each slab requested from the system
+ * @flags: SPLAY_POOL_* flags given at initialization
+ * @free_list: single linked list of free'd objects (last free'd first)
+ * @bump: next never used object in the newest slab
+ * @bump_end: end of the newest slab
+ * @slabs: list of all slabs owned by the pool
+ *
+ * The entries of a tree are usually allocated one by one. They are therefore
+ * scattered over the heap and each rotation touches a different cache line
+ * and page. A pool keeps them packed in large slabs. Objects are first handed
+ * out sequentially from the newest slab. Free'd objects are reused first to
+ * keep the working set of the pool small.
+ */
+struct splay_pool {
+	size_t obj_size;
+	size_t slab_size;
+	unsigned int flags;
+	void *free_list;
+	char *bump;
+	char *bump_end;
+	struct splay_pool_slab *slabs;
+};
+
+void splay_pool_init(struct splay_pool *pool, size_t obj_size,
+		     size_t slab_size, unsigned int flags);
+void *splay_pool_alloc(struct splay_pool *pool);
+void splay_pool_free(struct splay_pool *pool, void *obj);
+void splay_pool_free_all(struct splay_pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYPOOL_H__ */
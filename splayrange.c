@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions - range allocator
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include "splayrange.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaypool.h"
+#include "splaytree.h"
+
+/**
+ * splay_range_init() - Initialize allocator without free ranges
+ * @range: pointer to the range allocator
+ *
+ * The managed space has to be added with splay_range_free.
+ */
+void splay_range_init(struct splay_range *range)
+{
+	INIT_SPLAY_ROOT(&range->by_addr);
+	INIT_SPLAY_ROOT(&range->by_size);
+	splay_pool_init(&range->pool, sizeof(struct splay_range_extent), 0, 0);
+	range->free_units = 0;
+	range->extents = 0;
+}
+
+/**
+ * splay_range_destroy() - Free all resources of the allocator
+ * @range: pointer to the range allocator
+ */
+void splay_range_destroy(struct splay_range *range)
+{
+	splay_pool_free_all(&range->pool);
+	INIT_SPLAY_ROOT(&range->by_addr);
+	INIT_SPLAY_ROOT(&range->by_size);
+	range->free_units = 0;
+	range->extents = 0;
+}
+
+/**
+ * splay_range_from_addr() - Get extent of node in address tree
+ * @node: pointer to node in the address tree, can be NULL
+ *
+ * Return: pointer to extent containing @node, NULL when @node is NULL
+ */
+static struct splay_range_extent *splay_range_from_addr(struct splay_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return splay_entry(node, struct splay_range_extent, addr_node);
+}
+
+/**
+ * splay_range_from_size() - Get extent of node in size tree
+ * @node: pointer to node in the size tree, can be NULL
+ *
+ * Return: pointer to extent containing @node, NULL when @node is NULL
+ */
+static struct splay_range_extent *splay_range_from_size(struct splay_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return splay_entry(node, struct splay_range_extent, size_node);
+}
+
+/**
+ * splay_range_size_insert() - Add extent to size tree
+ * @range: pointer to the range allocator
+ * @extent: extent with initialized start and size
+ */
+static void splay_range_size_insert(struct splay_range *range,
+				    struct splay_range_extent *extent)
+{
+	struct splay_node **cur_nodep = &range->by_size.node;
+	struct splay_node *parent = NULL;
+	struct splay_range_extent *cur;
+
+	while (*cur_nodep) {
+		cur = splay_range_from_size(*cur_nodep);
+
+		parent = *cur_nodep;
+		if (extent->size < cur->size ||
+		    (extent->size == cur->size && extent->start < cur->start))
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+	}
+
+	splay_insert(&extent->size_node, parent, cur_nodep, &range->by_size);
+}
+
+/**
+ * splay_range_addr_insert() - Add extent to address tree
+ * @range: pointer to the range allocator
+ * @extent: extent with initialized start
+ */
+static void splay_range_addr_insert(struct splay_range *range,
+				    struct splay_range_extent *extent)
+{
+	struct splay_node **cur_nodep = &range->by_addr.node;
+	struct splay_node *parent = NULL;
+	struct splay_range_extent *cur;
+
+	while (*cur_nodep) {
+		cur = splay_range_from_addr(*cur_nodep);
+
+		parent = *cur_nodep;
+		if (extent->start < cur->start)
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+	}
+
+	splay_insert(&extent->addr_node, parent, cur_nodep, &range->by_addr);
+}
+
+/**
+ * splay_range_best_fit() - Search smallest extent with at least @size units
+ * @range: pointer to the range allocator
+ * @size: minimum number of units
+ *
+ * The found extent (or the last visited one) is splayed to the root of the
+ * size tree.
+ *
+ * Return: smallest (and lowest for equal sizes) extent with at least @size
+ *  units, NULL when no such extent exists
+ */
+static struct splay_range_extent *
+splay_range_best_fit(struct splay_range *range, uint64_t size)
+{
+	struct splay_node *node = range->by_size.node;
+	struct splay_node *found = NULL;
+	struct splay_node *last = NULL;
+	struct splay_range_extent *cur;
+
+	while (node) {
+		cur = splay_range_from_size(node);
+		last = node;
+
+		if (size <= cur->size) {
+			found = node;
+			node = node->left;
+		} else {
+			node = node->right;
+		}
+	}
+
+	if (found)
+		splay_splaying(found, &range->by_size);
+	else if (last)
+		splay_splaying(last, &range->by_size);
+
+	return splay_range_from_size(found);
+}
+
+/**
+ * splay_range_find_before() - Search last extent starting not after @start
+ * @range: pointer to the range allocator
+ * @start: unit to search
+ *
+ * The found extent (or the last visited one) is splayed to the root of the
+ * address tree.
+ *
+ * Return: last extent with start not larger than @start, NULL when no such
+ *  extent exists
+ */
+static struct splay_range_extent *
+splay_range_find_before(struct splay_range *range, uint64_t start)
+{
+	struct splay_node *node = range->by_addr.node;
+	struct splay_node *found = NULL;
+	struct splay_node *last = NULL;
+	struct splay_range_extent *cur;
+
+	while (node) {
+		cur = splay_range_from_addr(node);
+		last = node;
+
+		if (cur->start <= start) {
+			found = node;
+			node = node->right;
+		} else {
+			node = node->left;
+		}
+	}
+
+	if (found)
+		splay_splaying(found, &range->by_addr);
+	else if (last)
+		splay_splaying(last, &range->by_addr);
+
+	return splay_range_from_addr(found);
+}
+
+/**
+ * splay_range_extent_new() - Add new free extent
+ * @range: pointer to the range allocator
+ * @start: first unit of the extent
+ * @size: number of units in the extent
+ *
+ * Return: 0 on success, -1 when no descriptor could be allocated
+ */
+static int splay_range_extent_new(struct splay_range *range, uint64_t start,
+				  uint64_t size)
+{
+	struct splay_range_extent *extent;
+
+	extent = (struct splay_range_extent *)splay_pool_alloc(&range->pool);
+	if (!extent)
+		return -1;
+
+	extent->start = start;
+	extent->size = size;
+
+	splay_range_addr_insert(range, extent);
+	splay_range_size_insert(range, extent);
+	range->extents++;
+
+	return 0;
+}
+
+/**
+ * splay_range_extent_delete() - Remove free extent
+ * @range: pointer to the range allocator
+ * @extent: free extent of @range
+ */
+static void splay_range_extent_delete(struct splay_range *range,
+				      struct splay_range_extent *extent)
+{
+	splay_erase(&extent->addr_node, &range->by_addr);
+	splay_erase(&extent->size_node, &range->by_size);
+	splay_pool_free(&range->pool, extent);
+	range->extents--;
+}
+
+/**
+ * splay_range_extent_resize() - Change start and size of free extent
+ * @range: pointer to the range allocator
+ * @extent: free extent of @range
+ * @start: new first unit of the extent
+ * @size: new number of units in the extent
+ *
+ * The new start must not change the order of the extent in the address tree.
+ * It is therefore only updated in place. The extent is moved in the size
+ * tree.
+ */
+static void splay_range_extent_resize(struct splay_range *range,
+				      struct splay_range_extent *extent,
+				      uint64_t start, uint64_t size)
+{
+	splay_erase(&extent->size_node, &range->by_size);
+
+	extent->start = start;
+	extent->size = size;
+
+	splay_range_size_insert(range, extent);
+}
+
+/**
+ * splay_range_alloc() - Allocate range with best fit strategy
+ * @range: pointer to the range allocator
+ * @size: number of units to allocate
+ * @start: pointer to store the first unit of the allocated range
+ *
+ * The range is taken from the beginning of the smallest free extent which
+ * has at least @size units.
+ *
+ * Return: 0 on success, -1 when no free extent is large enough
+ */
+int splay_range_alloc(struct splay_range *range, uint64_t size,
+		      uint64_t *start)
+{
+	struct splay_range_extent *extent;
+
+	if (!size)
+		return -1;
+
+	extent = splay_range_best_fit(range, size);
+	if (!extent)
+		return -1;
+
+	*start = extent->start;
+	if (extent->size == size)
+		splay_range_extent_delete(range, extent);
+	else
+		splay_range_extent_resize(range, extent, extent->start + size,
+					  extent->size - size);
+
+	range->free_units -= size;
+
+	return 0;
+}
+
+/**
+ * splay_range_reserve() - Allocate range at a specific position
+ * @range: pointer to the range allocator
+ * @start: first unit of the range
+ * @size: number of units in the range
+ *
+ * Return: 0 on success, -1 when the range is not completely free or no
+ *  descriptor for the split extent could be allocated
+ */
+int splay_range_reserve(struct splay_range *range, uint64_t start,
+			uint64_t size)
+{
+	struct splay_range_extent *extent;
+	uint64_t extent_end;
+	uint64_t end = start + size;
+
+	if (!size || end < start)
+		return -1;
+
+	extent = splay_range_find_before(range, start);
+	if (!extent)
+		return -1;
+
+	extent_end = extent->start + extent->size;
+	if (extent_end < end)
+		return -1;
+
+	if (extent->start == start && extent_end == end) {
+		splay_range_extent_delete(range, extent);
+	} else if (extent->start == start) {
+		splay_range_extent_resize(range, extent, end,
+					  extent_end - end);
+	} else if (extent_end == end) {
+		splay_range_extent_resize(range, extent, extent->start,
+					  start - extent->start);
+	} else {
+		/* split the extent in the part before and after the range */
+		if (splay_range_extent_new(range, end, extent_end - end) < 0)
+			return -1;
+
+		splay_range_extent_resize(range, extent, extent->start,
+					  start - extent->start);
+	}
+
+	range->free_units -= size;
+
+	return 0;
+}
+
+/**
+ * splay_range_free() - Return range to the allocator
+ * @range: pointer to the range allocator
+ * @start: first unit of the range
+ * @size: number of units in the range
+ *
+ * The range is merged with the adjacent free extents. This function is also
+ * used to add the managed space to the allocator.
+ *
+ * Return: 0 on success, -1 when the range overlaps a free extent or no
+ *  descriptor for the new extent could be allocated
+ */
+int splay_range_free(struct splay_range *range, uint64_t start,
+		     uint64_t size)
+{
+	struct splay_range_extent *prev;
+	struct splay_range_extent *next;
+	uint64_t end = start + size;
+	uint64_t merged;
+	bool merge_prev;
+	bool merge_next;
+
+	if (!size || end < start)
+		return -1;
+
+	prev = splay_range_find_before(range, start);
+	if (prev) {
+		if (prev->start + prev->size > start)
+			return -1;
+
+		next = splay_range_from_addr(splay_next(&prev->addr_node));
+	} else {
+		next = splay_range_from_addr(splay_first(&range->by_addr));
+	}
+
+	if (next && next->start < end)
+		return -1;
+
+	merge_prev = prev && prev->start + prev->size == start;
+	merge_next = next && next->start == end;
+
+	if (merge_prev && merge_next) {
+		merged = prev->size + size + next->size;
+		splay_range_extent_delete(range, next);
+		splay_range_extent_resize(range, prev, prev->start, merged);
+	} else if (merge_prev) {
+		splay_range_extent_resize(range, prev, prev->start,
+					  prev->size + size);
+	} else if (merge_next) {
+		splay_range_extent_resize(range, next, start,
+					  next->size + size);
+	} else {
+		if (splay_range_extent_new(range, start, size) < 0)
+			return -1;
+	}
+
+	range->free_units += size;
+
+	return 0;
+}
+
+/**
+ * splay_range_alloc_bulk() - Allocate multiple ranges of the same size
+ * @range: pointer to the range allocator
+ * @size: number of units in each range
+ * @starts: array to store the first unit of each allocated range
+ * @count: number of ranges to allocate
+ *
+ * The first allocation splays the best fitting extent to the root of the
+ * size tree. The following allocations from the same extent are therefore
+ * found after a short search.
+ *
+ * Return: number of allocated ranges, smaller than @count when the allocator
+ *  ran out of large enough free extents
+ */
+size_t splay_range_alloc_bulk(struct splay_range *range, uint64_t size,
+			      uint64_t *starts, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (splay_range_alloc(range, size, &starts[i]) < 0)
+			break;
+	}
+
+	return i;
+}
+
+/**
+ * splay_range_reserve_bulk() - Allocate multiple ranges at specific positions
+ * @range: pointer to the range allocator
+ * @spans: array of ranges to allocate
+ * @count: number of entries in @spans
+ *
+ * The ranges are processed in array order and the processing stops at the
+ * first range which could not be reserved. Sorted @spans profit from the
+ * splaying of the neighbors in the address tree.
+ *
+ * Return: number of reserved ranges
+ */
+size_t splay_range_reserve_bulk(struct splay_range *range,
+				const struct splay_range_span *spans,
+				size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (splay_range_reserve(range, spans[i].start,
+					spans[i].size) < 0)
+			break;
+	}
+
+	return i;
+}
+
+/**
+ * splay_range_free_bulk() - Return multiple ranges to the allocator
+ * @range: pointer to the range allocator
+ * @spans: array of ranges to free
+ * @count: number of entries in @spans
+ *
+ * See splay_range_reserve_bulk.
+ *
+ * Return: number of free'd ranges
+ */
+size_t splay_range_free_bulk(struct splay_range *range,
+			     const struct splay_range_span *spans,
+			     size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (splay_range_free(range, spans[i].start, spans[i].size) < 0)
+			break;
+	}
+
+	return i;
+}
@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions - range allocator
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYRANGE_H__
+#define __SPLAYRANGE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaypool.h"
+#include "splaytree.h"
+
+/**
+ * struct splay_range_extent - free extent of a range allocator
+ * @addr_node: node in the tree of free extents ordered by start
+ * @size_node: node in the tree of free extents ordered by size and start
+ * @start: first unit of the extent
+ * @size: number of units in the extent
+ */
+struct splay_range_extent {
+	struct splay_node addr_node;
+	struct splay_node size_node;
+	uint64_t start;
+	uint64_t size;
+};
+
+/**
+ * struct splay_range_span - range for bulk operations
+ * @start: first unit of the range
+ * @size: number of units in the range
+ */
+struct splay_range_span {
+	uint64_t start;
+	uint64_t size;
+};
+
+/**
+ * struct splay_range - allocator for ranges of an address or offset space
+ * @by_addr: free extents ordered by start
+ * @by_size: free extents ordered by size (and start for equal sizes)
+ * @pool: pool for the extent descriptors
+ * @free_units: sum of the sizes of all free extents
+ * @extents: number of free extents
+ *
+ * The allocator only manages the free extents. Adjacent free extents are
+ * always coalesced. An allocation takes the smallest free extent which is
+ * large enough (best fit) from @by_size. A free searches its neighbors in
+ * @by_addr.
+ *
+ * The searched extents are splayed to the root of the trees. Repeated
+ * allocations of the same size and frees near recently freed ranges therefore
+ * only need short searches.
+ */
+struct splay_range {
+	struct splay_root by_addr;
+	struct splay_root by_size;
+	struct splay_pool pool;
+	uint64_t free_units;
+	size_t extents;
+};
+
+void splay_range_init(struct splay_range *range);
+void splay_range_destroy(struct splay_range *range);
+int splay_range_alloc(struct splay_range *range, uint64_t size,
+		      uint64_t *start);
+int splay_range_reserve(struct splay_range *range, uint64_t start,
+			uint64_t size);
+int splay_range_free(struct splay_range *range, uint64_t start,
+		     uint64_t size);
+size_t splay_range_alloc_bulk(struct splay_range *range, uint64_t size,
+			      uint64_t *starts, size_t count);
+size_t splay_range_reserve_bulk(struct splay_range *range,
+				const struct splay_range_span *spans,
+				size_t count);
+size_t splay_range_free_bulk(struct splay_range *range,
+			     const struct splay_range_span *spans,
+			     size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYRANGE_H__ */
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions - timer queue
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include "splaytimer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaytree.h"
+
+/**
+ * splay_timer_queue_init() - Initialize empty timer queue
+ * @queue: pointer to the timer queue
+ */
+void splay_timer_queue_init(struct splay_timer_queue *queue)
+{
+	INIT_SPLAY_ROOT(&queue->armed);
+	queue->first = NULL;
+	INIT_SPLAY_ROOT(&queue->expired);
+	queue->expire_next = NULL;
+	queue->count = 0;
+}
+
+/**
+ * splay_timer_init() - Initialize idle timer
+ * @timer: pointer to the timer
+ * @func: callback for the expired timer
+ */
+void splay_timer_init(struct splay_timer *timer, splay_timer_func_t func)
+{
+	timer->expires = 0;
+	timer->func = func;
+	timer->state = SPLAY_TIMER_IDLE;
+}
+
+/**
+ * splay_timer_from_node() - Get timer of tree node
+ * @node: pointer to tree node, can be NULL
+ *
+ * Return: pointer to timer containing @node, NULL when @node is NULL
+ */
+static struct splay_timer *splay_timer_from_node(struct splay_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return splay_entry(node, struct splay_timer, node);
+}
+
+/**
+ * splay_timer_leftmost() - Find leftmost node in subtree
+ * @node: root of the subtree, can be NULL
+ *
+ * Return: leftmost node of the subtree, NULL when @node is NULL
+ */
+static struct splay_node *splay_timer_leftmost(struct splay_node *node)
+{
+	if (!node)
+		return NULL;
+
+	while (node->left)
+		node = node->left;
+
+	return node;
+}
+
+/**
+ * splay_timer_pop_expired() - Remove next expired timer from expired tree
+ * @queue: pointer to the timer queue
+ *
+ * The expired timer with the earliest deadline has no left child. It can
+ * therefore be replaced by its right child without searching a successor.
+ * The next timer is the leftmost node of this right child or the parent.
+ * Popping all expired timers visits each node at most twice.
+ *
+ * Return: removed timer, NULL when no expired timer exists
+ */
+static struct splay_timer *
+splay_timer_pop_expired(struct splay_timer_queue *queue)
+{
+	struct splay_node *node = queue->expire_next;
+	struct splay_node *parent;
+	struct splay_node *right;
+
+	if (!node)
+		return NULL;
+
+	parent = node->parent;
+	right = node->right;
+
+	if (right)
+		right->parent = parent;
+
+	if (parent)
+		parent->left = right;
+	else
+		queue->expired.node = right;
+
+	if (right)
+		queue->expire_next = splay_timer_leftmost(right);
+	else
+		queue->expire_next = parent;
+
+	return splay_timer_from_node(node);
+}
+
+/**
+ * splay_timer_link() - Add idle timer to armed tree
+ * @queue: pointer to the timer queue
+ * @timer: pointer to the idle timer
+ *
+ * Timers with the same deadline are inserted after the existing ones.
+ */
+static void splay_timer_link(struct splay_timer_queue *queue,
+			     struct splay_timer *timer)
+{
+	struct splay_node **cur_nodep = &queue->armed.node;
+	struct splay_node *parent = NULL;
+	struct splay_timer *cur;
+	bool isminimal = true;
+
+	while (*cur_nodep) {
+		cur = splay_timer_from_node(*cur_nodep);
+
+		parent = *cur_nodep;
+		if (timer->expires < cur->expires) {
+			cur_nodep = &((*cur_nodep)->left);
+		} else {
+			cur_nodep = &((*cur_nodep)->right);
+			isminimal = false;
+		}
+	}
+
+	if (isminimal)
+		queue->first = timer;
+
+	timer->state = SPLAY_TIMER_ARMED;
+	queue->count++;
+
+	splay_insert(&timer->node, parent, cur_nodep, &queue->armed);
+}
+
+/**
+ * splay_timer_rearm_in_place() - Change deadline without moving the timer
+ * @timer: pointer to the armed timer
+ * @expires: new deadline of the timer
+ *
+ * The deadline is only changed when the timer keeps its position in the
+ * order of the armed timers. A re-armed timer must be queued behind all timers
+ * with the same deadline. It therefore has to be moved when the next timer
+ * doesn't expire strictly later. The tree is not modified in the other cases.
+ *
+ * Return: true when the deadline was changed, false when the timer must be
+ *  moved
+ */
+static bool splay_timer_rearm_in_place(struct splay_timer *timer,
+				       uint64_t expires)
+{
+	struct splay_timer *prev;
+	struct splay_timer *next;
+
+	prev = splay_timer_from_node(splay_prev(&timer->node));
+	if (prev && prev->expires > expires)
+		return false;
+
+	next = splay_timer_from_node(splay_next(&timer->node));
+	if (next && next->expires <= expires)
+		return false;
+
+	timer->expires = expires;
+
+	return true;
+}
+
+/**
+ * splay_timer_arm() - Arm or re-arm timer
+ * @queue: pointer to the timer queue
+ * @timer: pointer to the timer
+ * @expires: deadline of the timer
+ *
+ * An already armed timer is re-armed with the new deadline. It is only
+ * updated in place when the new deadline doesn't change its position between
+ * its neighbors. Otherwise, it is removed and inserted again.
+ */
+void splay_timer_arm(struct splay_timer_queue *queue,
+		     struct splay_timer *timer, uint64_t expires)
+{
+	if (timer->state == SPLAY_TIMER_ARMED) {
+		if (splay_timer_rearm_in_place(timer, expires))
+			return;
+	}
+
+	splay_timer_cancel(queue, timer);
+
+	timer->expires = expires;
+	splay_timer_link(queue, timer);
+}
+
+/**
+ * splay_timer_cancel() - Stop timer
+ * @queue: pointer to the timer queue
+ * @timer: pointer to the timer
+ *
+ * The timer is removed without splaying its parent. A timer which already
+ * expired but whose callback was not yet called (by the currently running
+ * splay_timer_expire) is also stopped.
+ *
+ * Return: 1 when the timer was stopped, 0 when it was idle
+ */
+int splay_timer_cancel(struct splay_timer_queue *queue,
+		       struct splay_timer *timer)
+{
+	struct splay_node *next;
+
+	switch (timer->state) {
+	case SPLAY_TIMER_IDLE:
+		return 0;
+	case SPLAY_TIMER_ARMED:
+		if (queue->first == timer) {
+			next = splay_next(&timer->node);
+			queue->first = splay_timer_from_node(next);
+		}
+
+		splay_erase_node(&timer->node, &queue->armed);
+		queue->count--;
+		break;
+	case SPLAY_TIMER_EXPIRING:
+		if (queue->expire_next == &timer->node)
+			splay_timer_pop_expired(queue);
+		else
+			splay_erase_node(&timer->node, &queue->expired);
+		break;
+	}
+
+	timer->state = SPLAY_TIMER_IDLE;
+
+	return 1;
+}
+
+/**
+ * splay_timer_split() - Move all timers with deadline <= @now to expired tree
+ * @queue: pointer to the timer queue
+ * @now: current time
+ *
+ * The first timer with a later deadline is splayed to the root of the armed
+ * tree. Its left subtree then contains exactly all expired timers and is
+ * moved as a whole.
+ *
+ * Return: number of expired timers
+ */
+static size_t splay_timer_split(struct splay_timer_queue *queue,
+				uint64_t now)
+{
+	struct splay_node *node = queue->armed.node;
+	struct splay_node *found = NULL;
+	struct splay_timer *cur;
+	struct splay_node *expired;
+	size_t count = 0;
+
+	while (node) {
+		cur = splay_timer_from_node(node);
+
+		if (now < cur->expires) {
+			found = node;
+			node = node->left;
+		} else {
+			node = node->right;
+		}
+	}
+
+	if (found) {
+		splay_splaying(found, &queue->armed);
+		expired = found->left;
+		found->left = NULL;
+	} else {
+		expired = queue->armed.node;
+		queue->armed.node = NULL;
+	}
+
+	if (!expired)
+		return 0;
+
+	expired->parent = NULL;
+	queue->expired.node = expired;
+	queue->expire_next = splay_timer_leftmost(expired);
+	queue->first = splay_timer_from_node(found);
+
+	for (node = queue->expire_next; node; node = splay_next(node)) {
+		cur = splay_timer_from_node(node);
+		cur->state = SPLAY_TIMER_EXPIRING;
+		count++;
+	}
+
+	queue->count -= count;
+
+	return count;
+}
+
+/**
+ * splay_timer_expire() - Call callbacks of all timers with deadline <= @now
+ * @queue: pointer to the timer queue
+ * @now: current time
+ *
+ * The callbacks are called in deadline order. Timers which are (re-)armed by
+ * a callback are not expired by this call - even when their deadline is not
+ * later than @now. Callbacks are allowed to arm and cancel any timer but must
+ * not call splay_timer_expire for the same queue.
+ *
+ * Return: number of called callbacks
+ */
+size_t splay_timer_expire(struct splay_timer_queue *queue, uint64_t now)
+{
+	struct splay_timer *timer;
+	size_t called = 0;
+
+	if (!queue->first || queue->first->expires > now)
+		return 0;
+
+	splay_timer_split(queue, now);
+
+	while ((timer = splay_timer_pop_expired(queue))) {
+		timer->state = SPLAY_TIMER_IDLE;
+		timer->func(timer);
+		called++;
+	}
+
+	return called;
+}
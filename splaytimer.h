@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: MIT */
+/* Minimal Splay-tree helper functions - timer queue
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#ifndef __SPLAYTIMER_H__
+#define __SPLAYTIMER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "splaytree.h"
+
+struct splay_timer;
+
+/**
+ * typedef splay_timer_func_t - callback for expired timer
+ * @timer: timer which expired
+ *
+ * The timer is no longer pending when the callback is called. It can be
+ * re-armed by the callback.
+ */
+typedef void (*splay_timer_func_t)(struct splay_timer *timer);
+
+/**
+ * enum splay_timer_state - state of a timer
+ * @SPLAY_TIMER_IDLE: timer is not in any queue
+ * @SPLAY_TIMER_ARMED: timer is waiting in the queue
+ * @SPLAY_TIMER_EXPIRING: timer expired and waits for its callback
+ */
+enum splay_timer_state {
+	SPLAY_TIMER_IDLE,
+	SPLAY_TIMER_ARMED,
+	SPLAY_TIMER_EXPIRING
+};
+
+/**
+ * struct splay_timer - timer in a timer queue
+ * @node: node in the armed or expiring tree of the queue
+ * @expires: deadline of the timer
+ * @func: callback for the expired timer
+ * @state: current state of the timer
+ *
+ * The timer is embedded in the object which should be notified. The object
+ * can be retrieved with splay_entry in the callback.
+ */
+struct splay_timer {
+	struct splay_node node;
+	uint64_t expires;
+	splay_timer_func_t func;
+	enum splay_timer_state state;
+};
+
+/**
+ * struct splay_timer_queue - queue of timers ordered by deadline
+ * @armed: tree of all armed timers
+ * @first: armed timer with earliest deadline
+ * @expired: tree of expired timers which still wait for their callback
+ * @expire_next: expired timer whose callback is called next
+ * @count: number of armed timers
+ *
+ * Timers with the same deadline expire in the order in which they were armed.
+ * splay_timer_expire moves all timers with expired deadlines with a single
+ * splay operation (split) from @armed to @expired and then calls their
+ * callbacks in deadline order.
+ */
+struct splay_timer_queue {
+	struct splay_root armed;
+	struct splay_timer *first;
+	struct splay_root expired;
+	struct splay_node *expire_next;
+	size_t count;
+};
+
+void splay_timer_queue_init(struct splay_timer_queue *queue);
+void splay_timer_init(struct splay_timer *timer, splay_timer_func_t func);
+void splay_timer_arm(struct splay_timer_queue *queue,
+		     struct splay_timer *timer, uint64_t expires);
+int splay_timer_cancel(struct splay_timer_queue *queue,
+		       struct splay_timer *timer);
+size_t splay_timer_expire(struct splay_timer_queue *queue, uint64_t now);
+
+/**
+ * splay_timer_pending() - Check if timer is armed
+ * @timer: pointer to the timer
+ *
+ * Return: !0 when the timer is armed, 0 when it is idle or already expired
+ */
+static __inline__ int splay_timer_pending(const struct splay_timer *timer)
+{
+	return timer->state == SPLAY_TIMER_ARMED;
+}
+
+/**
+ * splay_timer_first() - Get armed timer with earliest deadline
+ * @queue: pointer to the timer queue
+ *
+ * Return: pointer to the timer which expires next, NULL when no timer is armed
+ */
+static __inline__ struct splay_timer *
+splay_timer_first(const struct splay_timer_queue *queue)
+{
+	return queue->first;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPLAYTIMER_H__ */
@@ -8,6 +8,87 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(SPLAYTREE_TRACE) && !defined(SPLAYTREE_USDT)
+splay_trace_hook_t splay_trace_hook;
+
+/**
+ * splay_trace_set_hook() - Register function called at each trace point
+ * @hook: function to call, NULL to disable tracing
+ */
+void splay_trace_set_hook(splay_trace_hook_t hook)
+{
+	splay_trace_hook = hook;
+}
+#endif
+
+#ifdef SPLAYTREE_STATS
+/* iterations of different trees in different threads must not race on the
+ * shared counters
+ */
+#if defined(__GNUC__)
+#define SPLAY_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+      !defined(__STDC_NO_THREADS__)
+#define SPLAY_THREAD_LOCAL _Thread_local
+#else
+#define SPLAY_THREAD_LOCAL
+#endif
+
+static SPLAY_THREAD_LOCAL struct splay_iter_stats splay_iter_stats;
+
+#define splay_stats_add(root, counter, val) ((root)->stats.counter += (val))
+#define splay_iter_stats_add(counter, val) (splay_iter_stats.counter += (val))
+#else
+#define splay_stats_add(root, counter, val) do { } while (0)
+#define splay_iter_stats_add(counter, val) do { } while (0)
+#endif
+
+#ifdef SPLAYTREE_STATS
+/**
+ * splay_stats_depth() - Account depth of a splayed node in the statistics
+ * @stats: pointer to the statistics of the tree
+ * @depth: depth of the node before it was splayed to the root
+ */
+static void splay_stats_depth(struct splay_stats *stats, size_t depth)
+{
+	size_t bucket = 0;
+
+	stats->splayings++;
+	stats->path_length += depth;
+
+	while (depth) {
+		bucket++;
+		depth >>= 1;
+	}
+
+	stats->depth_hist[bucket]++;
+}
+
+/**
+ * splay_iter_stats_snapshot() - Copy iteration statistics of current thread
+ * @stats: pointer to the copy of the statistics
+ */
+void splay_iter_stats_snapshot(struct splay_iter_stats *stats)
+{
+	*stats = splay_iter_stats;
+}
+
+/**
+ * splay_iter_stats_reset() - Reset iteration statistics of current thread
+ */
+void splay_iter_stats_reset(void)
+{
+	memset(&splay_iter_stats, 0, sizeof(splay_iter_stats));
+}
+#else
+#define splay_stats_depth(stats, depth) ((void)(depth))
+#define splay_stats_merge(root, from) do { } while (0)
+#endif
 
 /**
  * splay_change_child() - Fix child entry of parent node
@@ -128,6 +209,154 @@ static struct splay_node *splay_rotate_right(struct splay_node *parent,
 	return tmp;
 }
 
+/**
+ * splay_zig_zig_left() - Move left-left grandchild to grandparent position
+ * @node: left child of @parent
+ * @parent: left child of @grandparent
+ * @grandparent: root of the subtree to restructure
+ * @root: pointer to splay root
+ *
+ * Equivalent to a right rotation at @grandparent followed by a right rotation
+ * at @parent. But each link is only written once and the child pointers of
+ * the great-grandparent are only checked once.
+ */
+static void splay_zig_zig_left(struct splay_node *node,
+			       struct splay_node *parent,
+			       struct splay_node *grandparent,
+			       struct splay_root *root)
+{
+	struct splay_node *top = grandparent->parent;
+	struct splay_node *child_b = node->right;
+	struct splay_node *child_c = parent->right;
+
+	grandparent->left = child_c;
+	if (child_c)
+		child_c->parent = grandparent;
+
+	parent->left = child_b;
+	if (child_b)
+		child_b->parent = parent;
+
+	parent->right = grandparent;
+	grandparent->parent = parent;
+
+	node->right = parent;
+	parent->parent = node;
+
+	node->parent = top;
+	splay_change_child(grandparent, node, top, root);
+}
+
+/**
+ * splay_zig_zig_right() - Move right-right grandchild to grandparent position
+ * @node: right child of @parent
+ * @parent: right child of @grandparent
+ * @grandparent: root of the subtree to restructure
+ * @root: pointer to splay root
+ *
+ * Mirror of splay_zig_zig_left.
+ */
+static void splay_zig_zig_right(struct splay_node *node,
+				struct splay_node *parent,
+				struct splay_node *grandparent,
+				struct splay_root *root)
+{
+	struct splay_node *top = grandparent->parent;
+	struct splay_node *child_b = node->left;
+	struct splay_node *child_c = parent->left;
+
+	grandparent->right = child_c;
+	if (child_c)
+		child_c->parent = grandparent;
+
+	parent->right = child_b;
+	if (child_b)
+		child_b->parent = parent;
+
+	parent->left = grandparent;
+	grandparent->parent = parent;
+
+	node->left = parent;
+	parent->parent = node;
+
+	node->parent = top;
+	splay_change_child(grandparent, node, top, root);
+}
+
+/**
+ * splay_zig_zag_left() - Move left-right grandchild to grandparent position
+ * @node: right child of @parent
+ * @parent: left child of @grandparent
+ * @grandparent: root of the subtree to restructure
+ * @root: pointer to splay root
+ *
+ * Equivalent to a left rotation at @parent followed by a right rotation at
+ * @grandparent. @parent becomes the left and @grandparent the right child of
+ * @node. Each link is only written once.
+ */
+static void splay_zig_zag_left(struct splay_node *node,
+			       struct splay_node *parent,
+			       struct splay_node *grandparent,
+			       struct splay_root *root)
+{
+	struct splay_node *top = grandparent->parent;
+	struct splay_node *child_b = node->left;
+	struct splay_node *child_c = node->right;
+
+	parent->right = child_b;
+	if (child_b)
+		child_b->parent = parent;
+
+	grandparent->left = child_c;
+	if (child_c)
+		child_c->parent = grandparent;
+
+	node->left = parent;
+	parent->parent = node;
+
+	node->right = grandparent;
+	grandparent->parent = node;
+
+	node->parent = top;
+	splay_change_child(grandparent, node, top, root);
+}
+
+/**
+ * splay_zig_zag_right() - Move right-left grandchild to grandparent position
+ * @node: left child of @parent
+ * @parent: right child of @grandparent
+ * @grandparent: root of the subtree to restructure
+ * @root: pointer to splay root
+ *
+ * Mirror of splay_zig_zag_left.
+ */
+static void splay_zig_zag_right(struct splay_node *node,
+				struct splay_node *parent,
+				struct splay_node *grandparent,
+				struct splay_root *root)
+{
+	struct splay_node *top = grandparent->parent;
+	struct splay_node *child_b = node->right;
+	struct splay_node *child_c = node->left;
+
+	parent->left = child_b;
+	if (child_b)
+		child_b->parent = parent;
+
+	grandparent->right = child_c;
+	if (child_c)
+		child_c->parent = grandparent;
+
+	node->right = parent;
+	parent->parent = node;
+
+	node->left = grandparent;
+	grandparent->parent = node;
+
+	node->parent = top;
+	splay_change_child(grandparent, node, top, root);
+}
+
 /**
  * splay_splaying() - Go tree upwards and splay @node to the root
  * @node: pointer to the new node
@@ -135,44 +364,67 @@ static struct splay_node *splay_rotate_right(struct splay_node *parent,
  *
  * The tree is traversed from bottom to the top starting at @node. The @node
  * will be moved upwards towards the @root of the tree.
+ *
+ * The zig-zig and zig-zag steps restructure the three involved nodes in a
+ * single step instead of two separate rotations.
  */
 void splay_splaying(struct splay_node *node, struct splay_root *root)
 {
 	struct splay_node *parent;
+	struct splay_node *grandparent;
+	bool node_right;
+	size_t depth = 0;
+
+	SPLAYTREE_PROBE(splaying_entry, SPLAY_TRACE_SPLAYING_ENTRY, node, 0, 0);
 
 	while (node->parent) {
 		parent = node->parent;
-		if (!parent->parent) {
+		grandparent = parent->parent;
+		node_right = splay_is_right_child(node);
+
+		if (!grandparent) {
 			/* zig step */
-			if (splay_is_right_child(node))
+			splay_stats_add(root, zig, 1);
+			depth += 1;
+			if (node_right)
 				splay_rotate_left(parent, root);
 			else
 				splay_rotate_right(parent, root);
 		} else {
-			if (splay_is_right_child(node)) {
+			depth += 2;
+			if (node_right) {
 				if (splay_is_right_child(parent)) {
 					/* zig-zig step */
-					splay_rotate_left(parent->parent, root);
-					splay_rotate_left(parent, root);
+					splay_stats_add(root, zigzig, 1);
+					splay_zig_zig_right(node, parent,
+							    grandparent, root);
 				} else {
 					/* zig-zag step */
-					splay_rotate_left(parent, root);
-					splay_rotate_right(node->parent, root);
+					splay_stats_add(root, zigzag, 1);
+					splay_zig_zag_left(node, parent,
+							   grandparent, root);
 				}
 			} else {
 				if (splay_is_right_child(parent)) {
 					/* zig-zag step */
-					splay_rotate_right(parent, root);
-					splay_rotate_left(node->parent, root);
+					splay_stats_add(root, zigzag, 1);
+					splay_zig_zag_right(node, parent,
+							    grandparent, root);
 				} else {
 					/* zig-zig step */
-					splay_rotate_right(parent->parent,
-							   root);
-					splay_rotate_right(parent, root);
+					splay_stats_add(root, zigzig, 1);
+					splay_zig_zig_left(node, parent,
+							   grandparent, root);
 				}
 			}
 		}
 	}
+
+	splay_stats_depth(&root->stats, depth);
+
+	/* each rotation moves the node exactly one level up */
+	SPLAYTREE_PROBE(splaying_exit, SPLAY_TRACE_SPLAYING_EXIT, node, depth,
+			depth);
 }
 
 /**
@@ -199,36 +451,48 @@ struct splay_node *splay_erase_node(struct splay_node *node,
 	struct splay_node *smallest;
 	struct splay_node *smallest_parent;
 	struct splay_node *decreased_node;
+	size_t search = 0;
+
+	SPLAYTREE_PROBE(erase_entry, SPLAY_TRACE_ERASE_ENTRY, node, 0, 0);
 
 	if (!node->left && !node->right) {
 		/* no child
 		 * just delete the current child
 		 */
+		splay_stats_add(root, erase_leaf, 1);
 		splay_change_child(node, NULL, node->parent, root);
 
+		SPLAYTREE_PROBE(erase_exit, SPLAY_TRACE_ERASE_EXIT, node, 0, 0);
 		return node->parent;
 	} else if (node->left && !node->right) {
 		/* one child, left
 		 * use left child as replacement for the deleted node
 		 */
+		splay_stats_add(root, erase_one_child, 1);
 		node->left->parent = node->parent;
 		splay_change_child(node, node->left, node->parent, root);
 
+		SPLAYTREE_PROBE(erase_exit, SPLAY_TRACE_ERASE_EXIT, node, 0, 0);
 		return node->parent;
 	} else if (!node->left) {
 		/* one child, right
 		 * use right child as replacement for the deleted node
 		 */
+		splay_stats_add(root, erase_one_child, 1);
 		node->right->parent = node->parent;
 		splay_change_child(node, node->right, node->parent, root);
 
+		SPLAYTREE_PROBE(erase_exit, SPLAY_TRACE_ERASE_EXIT, node, 0, 0);
 		return node->parent;
 	}
 
 	/* two children, take smallest of right (grand)children */
+	splay_stats_add(root, erase_two_children, 1);
 	smallest = node->right;
-	while (smallest->left)
+	while (smallest->left) {
 		smallest = smallest->left;
+		search++;
+	}
 
 	smallest_parent = smallest->parent;
 	if (smallest == node->right)
@@ -253,6 +517,7 @@ struct splay_node *splay_erase_node(struct splay_node *node,
 
 	splay_change_child(node, smallest, node->parent, root);
 
+	SPLAYTREE_PROBE(erase_exit, SPLAY_TRACE_ERASE_EXIT, node, search, 0);
 	return decreased_node;
 }
 
@@ -306,11 +571,16 @@ struct splay_node *splay_next(struct splay_node *node)
 {
 	struct splay_node *parent;
 
+	splay_iter_stats_add(calls, 1);
+
 	/* there is a right child - next node must be the leftmost under it */
 	if (node->right) {
 		node = node->right;
-		while (node->left)
+		splay_iter_stats_add(hops, 1);
+		while (node->left) {
 			node = node->left;
+			splay_iter_stats_add(hops, 1);
+		}
 
 		return node;
 	}
@@ -320,12 +590,15 @@ struct splay_node *splay_next(struct splay_node *node)
 	if (!parent)
 		return parent;
 
+	splay_iter_stats_add(hops, 1);
+
 	/* go up the tree until the path connecting both is the left child
 	 * pointer and therefore the parent is the next node
 	 */
 	while (parent && parent->right == node) {
 		node = parent;
 		parent = node->parent;
+		splay_iter_stats_add(hops, 1);
 	}
 
 	return parent;
@@ -341,11 +614,16 @@ struct splay_node *splay_prev(struct splay_node *node)
 {
 	struct splay_node *parent;
 
+	splay_iter_stats_add(calls, 1);
+
 	/* there is a left child - prev node must be the rightmost under it */
 	if (node->left) {
 		node = node->left;
-		while (node->right)
+		splay_iter_stats_add(hops, 1);
+		while (node->right) {
 			node = node->right;
+			splay_iter_stats_add(hops, 1);
+		}
 
 		return node;
 	}
@@ -355,13 +633,2549 @@ struct splay_node *splay_prev(struct splay_node *node)
 	if (!parent)
 		return parent;
 
+	splay_iter_stats_add(hops, 1);
+
 	/* go up the tree until the path connecting both is the right child
 	 * pointer and therefore the parent is the prev node
 	 */
 	while (parent && parent->left == node) {
 		node = parent;
 		parent = node->parent;
+		splay_iter_stats_add(hops, 1);
 	}
 
 	return parent;
 }
+
+/**
+ * splay_bound() - Search first node which is not before @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @cmp: comparison function between @key and the entry of a node
+ * @upper: false to stop at nodes equal to @key, true to skip them
+ *
+ * The found node is splayed to the root. The last visited node is splayed
+ * instead when no node was found.
+ *
+ * Return: first node with entry not smaller (@upper false) or larger (@upper
+ *  true) than @key, NULL if no such node exists
+ */
+static struct splay_node *splay_bound(struct splay_root *root,
+				      const void *key,
+				      int (*cmp)(const void *key,
+						 const struct splay_node *node),
+				      bool upper)
+{
+	struct splay_node *node = root->node;
+	struct splay_node *found = NULL;
+	struct splay_node *last = NULL;
+	int res;
+
+	while (node) {
+		last = node;
+
+		res = cmp(key, node);
+		if (res < 0 || (res == 0 && !upper)) {
+			found = node;
+			node = node->left;
+		} else {
+			node = node->right;
+		}
+	}
+
+	if (found)
+		splay_splaying(found, root);
+	else if (last)
+		splay_splaying(last, root);
+
+	return found;
+}
+
+/**
+ * splay_lower_bound() - Search first node not smaller than @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @cmp: comparison function between @key and the entry of a node. It must
+ *  return a negative value when @key is smaller, 0 when it is equal and a
+ *  positive value when @key is larger than the entry of node
+ *
+ * The found node is splayed to the root of the tree. The last visited node is
+ * splayed instead when no node was found. Otherwise repeated unsuccessful
+ * searches would not adjust the tree.
+ *
+ * Return: first node not smaller than @key, NULL if no such node exists
+ */
+struct splay_node *splay_lower_bound(struct splay_root *root, const void *key,
+				     int (*cmp)(const void *key,
+						const struct splay_node *node))
+{
+	return splay_bound(root, key, cmp, false);
+}
+
+/**
+ * splay_upper_bound() - Search first node larger than @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @cmp: comparison function between @key and the entry of a node
+ *
+ * See splay_lower_bound.
+ *
+ * Return: first node larger than @key, NULL if no such node exists
+ */
+struct splay_node *splay_upper_bound(struct splay_root *root, const void *key,
+				     int (*cmp)(const void *key,
+						const struct splay_node *node))
+{
+	return splay_bound(root, key, cmp, true);
+}
+
+/**
+ * splay_equal_range() - Search all nodes equal to @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @cmp: comparison function between @key and the entry of a node
+ * @first: pointer to store the first node equal to @key, NULL when no such
+ *  node exists
+ * @end: pointer to store the first node larger than @key, NULL when no such
+ *  node exists
+ *
+ * The nodes from @first (inclusive) to @end (exclusive) can be visited with
+ * splay_next. The first equal node (or the last visited node when there is no
+ * equal node) is the root of the tree after the search.
+ *
+ * Return: number of nodes equal to @key
+ */
+size_t splay_equal_range(struct splay_root *root, const void *key,
+			 int (*cmp)(const void *key,
+				    const struct splay_node *node),
+			 struct splay_node **first, struct splay_node **end)
+{
+	struct splay_node *upper;
+	struct splay_node *lower;
+	struct splay_node *node;
+	size_t count = 0;
+
+	upper = splay_bound(root, key, cmp, true);
+	lower = splay_bound(root, key, cmp, false);
+
+	for (node = lower; node != upper; node = splay_next(node))
+		count++;
+
+	if (!count)
+		lower = NULL;
+
+	if (first)
+		*first = lower;
+	if (end)
+		*end = upper;
+
+	return count;
+}
+
+/**
+ * splay_count() - Count nodes equal to @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @cmp: comparison function between @key and the entry of a node
+ *
+ * See splay_equal_range.
+ *
+ * Return: number of nodes equal to @key
+ */
+size_t splay_count(struct splay_root *root, const void *key,
+		   int (*cmp)(const void *key, const struct splay_node *node))
+{
+	return splay_equal_range(root, key, cmp, NULL, NULL);
+}
+
+/**
+ * splay_split() - Split tree at key
+ * @root: pointer to splay root of the tree to split
+ * @key: key at which the tree is split
+ * @cmp: comparison function between @key and the entry of a node
+ * @right: pointer to splay root which receives all nodes larger than @key
+ *
+ * All nodes smaller than @key stay in @root. A node equal to @key is removed
+ * from the tree. The tree must not contain multiple nodes equal to @key. The
+ * split only needs a single splay operation. @right is initialized by this
+ * function and must not contain any nodes.
+ *
+ * Return: removed node equal to @key, NULL if no such node exists
+ */
+struct splay_node *splay_split(struct splay_root *root, const void *key,
+			       int (*cmp)(const void *key,
+					  const struct splay_node *node),
+			       struct splay_root *right)
+{
+	struct splay_node *found;
+
+	INIT_SPLAY_ROOT(right);
+
+	found = splay_bound(root, key, cmp, false);
+	if (!found)
+		return NULL;
+
+	/* found node is now the root without smaller nodes on the right */
+	root->node = found->left;
+	if (root->node)
+		root->node->parent = NULL;
+	found->left = NULL;
+
+	if (cmp(key, found) < 0) {
+		right->node = found;
+		return NULL;
+	}
+
+	right->node = found->right;
+	if (right->node)
+		right->node->parent = NULL;
+	found->right = NULL;
+
+	return found;
+}
+
+/**
+ * splay_join() - Append tree to other tree
+ * @root: pointer to splay root of the tree to extend
+ * @middle: node between the two trees, can be NULL
+ * @right: pointer to splay root of the tree to append
+ *
+ * All nodes of @root must be smaller than @middle and all nodes of @right
+ * must be larger than @middle (or than all nodes of @root when @middle is
+ * NULL). All nodes are moved to @root and @right is empty afterwards. With
+ * @middle, it becomes the new root and no splay operation is needed.
+ */
+void splay_join(struct splay_root *root, struct splay_node *middle,
+		struct splay_root *right)
+{
+	struct splay_node *last;
+
+	if (middle) {
+		middle->parent = NULL;
+		middle->left = root->node;
+		middle->right = right->node;
+
+		if (middle->left)
+			middle->left->parent = middle;
+		if (middle->right)
+			middle->right->parent = middle;
+
+		root->node = middle;
+		right->node = NULL;
+		return;
+	}
+
+	if (!right->node)
+		return;
+
+	if (!root->node) {
+		root->node = right->node;
+		right->node = NULL;
+		return;
+	}
+
+	/* the last node has no right child after being splayed to the root */
+	last = splay_last(root);
+	splay_splaying(last, root);
+	last->right = right->node;
+	right->node->parent = last;
+	right->node = NULL;
+}
+
+/**
+ * splay_set_recurse() - Combine two subtrees with set operation
+ * @op: set operation
+ * @root: subtree of the first tree, receives the result
+ * @other: subtree of the second tree, receives the remaining nodes
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ *
+ * The root of @other splits @root into two smaller problems. Their results
+ * are joined again with the nodes equal to the root of @other in between.
+ * The statistics of the temporary roots of the right halves are added to
+ * @root and @other afterwards.
+ */
+static void splay_set_recurse(enum splay_set_op op, struct splay_root *root,
+			      struct splay_root *other,
+			      int (*cmp)(const void *key,
+					 const struct splay_node *node))
+{
+	struct splay_root root_right;
+	struct splay_root other_right;
+	struct splay_root empty;
+	struct splay_node *pivot;
+	struct splay_node *equal;
+	struct splay_node *keep;
+
+	if (!root->node || !other->node) {
+		switch (op) {
+		case SPLAY_SET_UNION:
+			splay_join(root, NULL, other);
+			break;
+		case SPLAY_SET_INTERSECTION:
+			splay_join(other, NULL, root);
+			break;
+		case SPLAY_SET_DIFFERENCE:
+			break;
+		}
+
+		return;
+	}
+
+	pivot = other->node;
+	other->node = pivot->left;
+	if (other->node)
+		other->node->parent = NULL;
+
+	INIT_SPLAY_ROOT(&other_right);
+	other_right.node = pivot->right;
+	if (other_right.node)
+		other_right.node->parent = NULL;
+
+	equal = splay_split(root, pivot, cmp, &root_right);
+
+	splay_set_recurse(op, root, other, cmp);
+	splay_set_recurse(op, &root_right, &other_right, cmp);
+
+	switch (op) {
+	case SPLAY_SET_UNION:
+		keep = equal ? equal : pivot;
+		break;
+	case SPLAY_SET_INTERSECTION:
+		keep = equal;
+		break;
+	case SPLAY_SET_DIFFERENCE:
+	default:
+		keep = NULL;
+		break;
+	}
+
+	splay_join(root, keep, &root_right);
+
+	if (equal && equal != keep) {
+		INIT_SPLAY_ROOT(&empty);
+		splay_join(other, equal, &empty);
+	}
+
+	if (pivot != keep)
+		splay_join(other, pivot, &other_right);
+	else
+		splay_join(other, NULL, &other_right);
+
+	splay_stats_merge(root, &root_right);
+	splay_stats_merge(other, &other_right);
+}
+
+/**
+ * splay_set_operation() - Combine two trees with set operation
+ * @root: pointer to splay root of the first tree, receives the result
+ * @other: pointer to splay root of the second tree, receives the remaining
+ *  nodes
+ * @op: set operation
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ *
+ * None of the trees must contain multiple equal nodes. The result of the set
+ * operation is stored in @root. When a node is found in both trees then the
+ * node of @root is used for the result. All nodes which are not part of the
+ * result are stored in @other. They can be released afterwards by iterating
+ * over @other.
+ *
+ * The trees are not merged node by node. Instead, each root of a subtree of
+ * @other splits the matching part of @root and both halves are processed
+ * independently. The results are joined again without extra splaying.
+ *
+ * The recursion depth is the height of @other. A splay tree can degenerate to
+ * a single long path (for example after inserting sorted keys) and would then
+ * overflow the stack. @other is therefore first rebuilt by splay_rebalance in
+ * O(m) time for m nodes in @other. Afterwards, the recursion depth is at most
+ * floor(log2(m)) + 1 and the work is O(m log(n/m + 1)) for n nodes in @root.
+ */
+void splay_set_operation(struct splay_root *root, struct splay_root *other,
+			 enum splay_set_op op,
+			 int (*cmp)(const void *key,
+				    const struct splay_node *node))
+{
+	splay_rebalance(other);
+	splay_set_recurse(op, root, other, cmp);
+}
+
+/**
+ * splay_rebalance_compress() - Rotate every second node of vine to the left
+ * @pseudo: pseudo root whose right child is the vine
+ * @count: number of left rotations
+ */
+static void splay_rebalance_compress(struct splay_node *pseudo, size_t count)
+{
+	struct splay_node *scanner = pseudo;
+	struct splay_node *child;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		child = scanner->right;
+
+		scanner->right = child->right;
+		scanner->right->parent = scanner;
+		scanner = scanner->right;
+
+		child->right = scanner->left;
+		if (child->right)
+			child->right->parent = child;
+
+		scanner->left = child;
+		child->parent = scanner;
+	}
+}
+
+/**
+ * splay_rebalance() - Rebuild tree as balanced tree
+ * @root: pointer to splay root
+ *
+ * The Day-Stout-Warren algorithm first rotates the tree into a sorted list
+ * (vine) of right children and then compresses the vine with left rotations
+ * into a complete tree. It needs O(n) time and no extra memory. Afterwards,
+ * no access path is longer than floor(log2(n)) + 1 nodes.
+ *
+ * Return: number of nodes in the tree
+ */
+size_t splay_rebalance(struct splay_root *root)
+{
+	struct splay_node pseudo;
+	struct splay_node *tail;
+	struct splay_node *rest;
+	struct splay_node *tmp;
+	size_t leaves;
+	size_t count = 0;
+	size_t size;
+
+	if (!root->node)
+		return 0;
+
+	pseudo.parent = NULL;
+	pseudo.left = NULL;
+	pseudo.right = root->node;
+	root->node->parent = &pseudo;
+
+	/* tree to vine */
+	tail = &pseudo;
+	rest = tail->right;
+	while (rest) {
+		if (!rest->left) {
+			tail = rest;
+			rest = rest->right;
+			count++;
+			continue;
+		}
+
+		tmp = rest->left;
+		rest->left = tmp->right;
+		if (rest->left)
+			rest->left->parent = rest;
+
+		tmp->right = rest;
+		rest->parent = tmp;
+
+		tail->right = tmp;
+		tmp->parent = tail;
+		rest = tmp;
+	}
+
+	/* vine to tree - the bottom level only gets the remaining leaves */
+	size = 1;
+	while (size <= count + 1)
+		size <<= 1;
+	leaves = count + 1 - (size >> 1);
+
+	splay_rebalance_compress(&pseudo, leaves);
+	size = count - leaves;
+	while (size > 1) {
+		splay_rebalance_compress(&pseudo, size / 2);
+		size /= 2;
+	}
+
+	root->node = pseudo.right;
+	root->node->parent = NULL;
+
+	return count;
+}
+
+/**
+ * splay_depth() - Get depth of node in tree
+ * @node: pointer to the node
+ *
+ * Return: number of edges between @node and the root of the tree
+ */
+size_t splay_depth(const struct splay_node *node)
+{
+	size_t depth = 0;
+
+	while (node->parent) {
+		node = node->parent;
+		depth++;
+	}
+
+	return depth;
+}
+
+/**
+ * splay_balance_check() - Rebalance tree after too deep access path
+ * @balance: pointer to rebalance policy
+ * @root: pointer to splay root
+ * @depth: number of edges of the access path, for example from splay_depth
+ *  or counted while searching the node
+ *
+ * The access path is too deep when it is longer than the factor of the
+ * policy times floor(log2(n)) + 1 edges. The tree is then rebuilt with
+ * splay_rebalance and the node count of the policy is corrected. The check
+ * must not be done between a search and the splay operation of the found
+ * node because the found node is not the root after a rebalance.
+ *
+ * Return: !0 when the tree was rebalanced, 0 otherwise
+ */
+int splay_balance_check(struct splay_balance *balance,
+			struct splay_root *root, size_t depth)
+{
+	size_t count = balance->count;
+	size_t limit = 1;
+
+	while (count > 1) {
+		count >>= 1;
+		limit++;
+	}
+
+	if (depth <= balance->factor * limit)
+		return 0;
+
+	balance->count = splay_rebalance(root);
+	balance->rebalances++;
+
+	return 1;
+}
+
+/**
+ * splay_frozen_elem() - Get address of Eytzinger array element
+ * @base: pointer to the first element of the array
+ * @pos: 1-based position in the implicit Eytzinger tree
+ * @size: size of each element in the array
+ *
+ * Return: pointer to the element at @pos
+ */
+static void *splay_frozen_elem(const void *base, size_t pos, size_t size)
+{
+	return (char *)base + (pos - 1) * size;
+}
+
+/**
+ * splay_frozen_leftmost() - Find leftmost position under implicit subtree
+ * @pos: 1-based position of the subtree root
+ * @nmemb: number of elements in the array
+ *
+ * Return: 1-based position of leftmost element under @pos
+ */
+static size_t splay_frozen_leftmost(size_t pos, size_t nmemb)
+{
+	while (2 * pos <= nmemb)
+		pos = 2 * pos;
+
+	return pos;
+}
+
+/**
+ * splay_frozen_successor() - Find in-order successor in implicit tree
+ * @pos: 1-based position of the current element
+ * @nmemb: number of elements in the array
+ *
+ * Return: 1-based position of the successor, 0 when @pos is the last one
+ */
+static size_t splay_frozen_successor(size_t pos, size_t nmemb)
+{
+	/* there is a right child - next one must be the leftmost under it */
+	if (2 * pos + 1 <= nmemb)
+		return splay_frozen_leftmost(2 * pos + 1, nmemb);
+
+	/* go up the tree until the path connecting both is the left child
+	 * and therefore the parent is the next element
+	 */
+	while (pos & 1)
+		pos >>= 1;
+
+	return pos >> 1;
+}
+
+/**
+ * splay_freeze() - Store tree nodes in an Eytzinger ordered search array
+ * @root: pointer to splay root
+ * @base: pointer to the first element of the search array
+ * @nmemb: number of elements available in @base
+ * @size: size of each element in @base
+ * @store: callback which fills an element of @base for a node
+ *
+ * The tree is walked in-order via splay_first and splay_next. The nodes are
+ * handed to @store together with the element at their position in the
+ * implicit Eytzinger (breadth-first) layout of @base. The tree itself is not
+ * modified - no splaying is done.
+ *
+ * The elements should only contain the (small) keys required for the search
+ * and optionally a pointer to the node to allow splay_thaw to rebuild the tree.
+ * @base should be aligned to the cache line size.
+ *
+ * Nothing is stored when @nmemb is smaller than the number of nodes in the
+ * tree.
+ *
+ * Return: number of nodes in the tree
+ */
+size_t splay_freeze(const struct splay_root *root, void *base, size_t nmemb,
+		    size_t size,
+		    void (*store)(void *elem, struct splay_node *node))
+{
+	struct splay_node *node;
+	size_t count = 0;
+	size_t pos;
+
+	for (node = splay_first(root); node; node = splay_next(node))
+		count++;
+
+	if (count > nmemb)
+		return count;
+
+	pos = splay_frozen_leftmost(1, count);
+	for (node = splay_first(root); node; node = splay_next(node)) {
+		store(splay_frozen_elem(base, pos, size), node);
+		pos = splay_frozen_successor(pos, count);
+	}
+
+	return count;
+}
+
+/**
+ * splay_frozen_first() - Find index of smallest element in search array
+ * @nmemb: number of elements in the search array
+ *
+ * Return: index of the smallest element, @nmemb when array is empty
+ */
+size_t splay_frozen_first(size_t nmemb)
+{
+	if (!nmemb)
+		return nmemb;
+
+	return splay_frozen_leftmost(1, nmemb) - 1;
+}
+
+/**
+ * splay_frozen_next() - Find index of successor in search array
+ * @index: index of the current element
+ * @nmemb: number of elements in the search array
+ *
+ * Return: index of the successor element, @nmemb when no successor exists
+ */
+size_t splay_frozen_next(size_t index, size_t nmemb)
+{
+	size_t pos;
+
+	pos = splay_frozen_successor(index + 1, nmemb);
+	if (!pos)
+		return nmemb;
+
+	return pos - 1;
+}
+
+/**
+ * splay_frozen_lower_bound() - Search first element not smaller than key
+ * @base: pointer to the first element of the search array
+ * @nmemb: number of elements in the search array
+ * @size: size of each element in @base
+ * @key: pointer to the key to search for
+ * @compar: comparison function for @key and an element (like bsearch)
+ *
+ * The next position in the implicit tree is calculated from the result of
+ * @compar instead of branching on it. @compar itself is still called once
+ * per level. The first of the 16 descendants four levels further down is
+ * prefetched to hide the memory latency for larger arrays. They are stored
+ * next to each other and usually share one or two cache lines.
+ *
+ * Return: index of first element not smaller than @key, @nmemb when all
+ *  elements are smaller than @key
+ */
+size_t splay_frozen_lower_bound(const void *base, size_t nmemb, size_t size,
+				const void *key,
+				int (*compar)(const void *key,
+					      const void *elem))
+{
+	size_t pos = 1;
+
+	while (pos <= nmemb) {
+#if defined(__GNUC__)
+		/* only prefetch elements inside the array */
+		if (pos <= nmemb / 16)
+			__builtin_prefetch(splay_frozen_elem(base, 16 * pos,
+							     size));
+#endif
+		pos = 2 * pos +
+		      (compar(key, splay_frozen_elem(base, pos, size)) > 0);
+	}
+
+	/* drop the right turns at the end of the path and then the last left
+	 * turn to get the element at which the search went the last time left
+	 */
+	while (pos & 1)
+		pos >>= 1;
+	pos >>= 1;
+
+	if (!pos)
+		return nmemb;
+
+	return pos - 1;
+}
+
+/**
+ * splay_thaw() - Rebuild tree from an Eytzinger ordered search array
+ * @root: pointer to splay root
+ * @base: pointer to the first element of the search array
+ * @nmemb: number of elements in the search array
+ * @size: size of each element in @base
+ * @load: callback which returns the node for an element of @base
+ *
+ * The implicit tree of the search array is linked as a new tree in @root.
+ * No comparisons are necessary and the resulting tree is balanced. The tree
+ * in @root is overwritten and must not contain any nodes.
+ */
+void splay_thaw(struct splay_root *root, void *base, size_t nmemb,
+		size_t size, struct splay_node *(*load)(void *elem))
+{
+	struct splay_node *node;
+	struct splay_node *parent;
+	size_t pos;
+
+	root->node = NULL;
+
+	/* parents are always visited before their children */
+	for (pos = 1; pos <= nmemb; pos++) {
+		node = load(splay_frozen_elem(base, pos, size));
+
+		if (pos == 1) {
+			splay_link_node(node, NULL, &root->node);
+			continue;
+		}
+
+		parent = load(splay_frozen_elem(base, pos / 2, size));
+		if (pos & 1)
+			splay_link_node(node, parent, &parent->right);
+		else
+			splay_link_node(node, parent, &parent->left);
+	}
+}
+
+/**
+ * splay_relayout_copy() - Copy entry of node to next free arena slot
+ * @node: splay node of the entry to copy
+ * @arena: pointer to the first entry slot of the arena
+ * @used: number of already used slots in @arena
+ * @entry_size: size of each entry (and arena slot)
+ * @node_offset: offset of the splay node in the entry
+ * @relocate: callback informed about the new entry address, can be NULL
+ * @priv: private data for @relocate
+ *
+ * Return: splay node of the copied entry
+ */
+static struct splay_node *
+splay_relayout_copy(struct splay_node *node, void *arena, size_t *used,
+		    size_t entry_size, size_t node_offset,
+		    void (*relocate)(void *old_entry, void *new_entry,
+				     void *priv),
+		    void *priv)
+{
+	char *old_entry = (char *)node - node_offset;
+	char *new_entry = (char *)arena + *used * entry_size;
+
+	memcpy(new_entry, old_entry, entry_size);
+	(*used)++;
+
+	if (relocate)
+		relocate(old_entry, new_entry, priv);
+
+	return (struct splay_node *)(new_entry + node_offset);
+}
+
+/**
+ * splay_relayout() - Copy all entries into breadth-first ordered arena
+ * @root: pointer to splay root
+ * @arena: pointer to memory for the relocated entries
+ * @nmemb: number of entries which fit into @arena
+ * @entry_size: size of each entry
+ * @node_offset: offset of the splay node in the entry (offsetof)
+ * @relocate: callback informed about each moved entry, can be NULL
+ * @priv: private data for @relocate
+ *
+ * The entries are copied in breadth-first order of the current tree shape to
+ * @arena. The root is stored in the first slot and nodes of the same depth
+ * are next to each other. The top levels of the tree, which are used by all
+ * accesses, are therefore packed into few cache lines and pages.
+ *
+ * All parent/left/right links are fixed to the new entries. No extra memory
+ * beside @arena is required because the arena itself is used as queue for the
+ * breadth-first traversal.
+ *
+ * @relocate is called directly after an entry was copied. The old entry is not
+ * accessed again by splay_relayout and can therefore be free'd by @relocate.
+ * The links in the new entry are not yet fixed when @relocate is called.
+ *
+ * Nothing is copied when @nmemb is smaller than the number of nodes in the
+ * tree.
+ *
+ * Return: number of nodes in the tree
+ */
+size_t splay_relayout(struct splay_root *root, void *arena, size_t nmemb,
+		      size_t entry_size, size_t node_offset,
+		      void (*relocate)(void *old_entry, void *new_entry,
+				       void *priv),
+		      void *priv)
+{
+	struct splay_node *node;
+	size_t count = 0;
+	size_t used = 0;
+	size_t pos;
+
+	for (node = splay_first(root); node; node = splay_next(node))
+		count++;
+
+	if (count > nmemb || count == 0)
+		return count;
+
+	root->node = splay_relayout_copy(root->node, arena, &used, entry_size,
+					 node_offset, relocate, priv);
+	root->node->parent = NULL;
+
+	/* copy children of the already moved entries in queue order */
+	for (pos = 0; pos < used; pos++) {
+		node = (struct splay_node *)((char *)arena + pos * entry_size +
+					     node_offset);
+
+		if (node->left) {
+			node->left = splay_relayout_copy(node->left, arena,
+							 &used, entry_size,
+							 node_offset, relocate,
+							 priv);
+			node->left->parent = node;
+		}
+
+		if (node->right) {
+			node->right = splay_relayout_copy(node->right, arena,
+							  &used, entry_size,
+							  node_offset, relocate,
+							  priv);
+			node->right->parent = node;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * struct splay_build_state - state to link balanced tree from sorted nodes
+ * @last: last linked node for each depth
+ * @count: number of nodes in the final tree
+ * @pos: 1-based position of next node in implicit complete tree
+ * @depth: depth of @pos in implicit complete tree
+ *
+ * The nodes are linked in-order into the shape of a complete tree. The left
+ * child of a new node is always the last linked node one level below it. And
+ * a new right child always belongs to the last linked node one level above.
+ */
+struct splay_build_state {
+	struct splay_node *last[sizeof(size_t) * 8 + 1];
+	size_t count;
+	size_t pos;
+	size_t depth;
+};
+
+/**
+ * splay_build_init() - Initialize state to link balanced tree
+ * @state: pointer to build state
+ * @count: number of nodes in the final tree
+ */
+static void splay_build_init(struct splay_build_state *state, size_t count)
+{
+	state->count = count;
+	state->pos = 1;
+	state->depth = 0;
+
+	while (2 * state->pos <= count) {
+		state->pos = 2 * state->pos;
+		state->depth++;
+	}
+}
+
+/**
+ * splay_build_add() - Link next (in-order) node into balanced tree
+ * @state: pointer to build state
+ * @node: next node which is larger than all previously added nodes
+ * @root: pointer to splay root
+ */
+static void splay_build_add(struct splay_build_state *state,
+			    struct splay_node *node, struct splay_root *root)
+{
+	size_t pos = state->pos;
+	size_t depth = state->depth;
+
+	node->parent = NULL;
+	node->left = NULL;
+	node->right = NULL;
+
+	if (2 * pos <= state->count) {
+		node->left = state->last[depth + 1];
+		node->left->parent = node;
+	}
+
+	if (pos == 1) {
+		root->node = node;
+	} else if (pos & 1) {
+		node->parent = state->last[depth - 1];
+		node->parent->right = node;
+	}
+
+	state->last[depth] = node;
+
+	/* find position of in-order successor */
+	if (2 * pos + 1 <= state->count) {
+		pos = 2 * pos + 1;
+		depth++;
+
+		while (2 * pos <= state->count) {
+			pos = 2 * pos;
+			depth++;
+		}
+	} else {
+		while (pos & 1) {
+			pos >>= 1;
+			depth--;
+		}
+
+		pos >>= 1;
+		depth--;
+	}
+
+	state->pos = pos;
+	state->depth = depth;
+}
+
+/**
+ * splay_preorder_next() - Find next node in preorder
+ * @node: starting splay node for search
+ *
+ * Return: pointer to next node in preorder. NULL when @node is the last one.
+ */
+static struct splay_node *splay_preorder_next(struct splay_node *node)
+{
+	struct splay_node *parent;
+
+	if (node->left)
+		return node->left;
+
+	if (node->right)
+		return node->right;
+
+	/* go up the tree until a right subtree wasn't visited yet */
+	parent = node->parent;
+	while (parent && (parent->right == node || !parent->right)) {
+		node = parent;
+		parent = node->parent;
+	}
+
+	if (!parent)
+		return parent;
+
+	return parent->right;
+}
+
+#define SPLAY_SERIALIZE_HEADER_LEN	24
+
+static const unsigned char splay_serialize_magic[4] = { 'S', 'P', 'L', 'Y' };
+
+/**
+ * splay_put_le() - Store value as little endian bytes
+ * @buf: pointer to output buffer
+ * @val: value to store
+ * @len: number of bytes to store
+ */
+static void splay_put_le(unsigned char *buf, uint64_t val, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		buf[i] = (unsigned char)(val & 0xff);
+		val >>= 8;
+	}
+}
+
+/**
+ * splay_get_le() - Load value from little endian bytes
+ * @buf: pointer to input buffer
+ * @len: number of bytes to load
+ *
+ * Return: loaded value
+ */
+static uint64_t splay_get_le(const unsigned char *buf, size_t len)
+{
+	uint64_t val = 0;
+	size_t i;
+
+	for (i = len; i > 0; i--) {
+		val <<= 8;
+		val |= buf[i - 1];
+	}
+
+	return val;
+}
+
+/**
+ * splay_serialize() - Write all entries of a tree to a file
+ * @root: pointer to splay root
+ * @fp: file to write to
+ * @size: size of the record written for each entry
+ * @flags: bitmask of SPLAY_SERIALIZE_* flags
+ * @store: callback which fills the record for a node
+ * @priv: private data for @store
+ *
+ * A small header is followed by the records of all entries. The records are
+ * written in-order. Nodes are written in preorder when the shape of the
+ * tree should be stored via SPLAY_SERIALIZE_SHAPE. The shape is then stored
+ * as two bits per node in front of the records. The content of the records
+ * (and its byte order) is completely defined by @store.
+ *
+ * The tree is not modified - no splaying is done.
+ *
+ * Return: 0 on success, -1 on errors
+ */
+int splay_serialize(const struct splay_root *root, FILE *fp, size_t size,
+		    unsigned int flags,
+		    void (*store)(void *record, struct splay_node *node,
+				  void *priv),
+		    void *priv)
+{
+	unsigned char header[SPLAY_SERIALIZE_HEADER_LEN];
+	struct splay_node *node;
+	unsigned char *record;
+	unsigned int bits = 0;
+	unsigned int nbits = 0;
+	size_t count = 0;
+	int ret = -1;
+
+	for (node = splay_first(root); node; node = splay_next(node))
+		count++;
+
+	memcpy(header, splay_serialize_magic, sizeof(splay_serialize_magic));
+	splay_put_le(&header[4], flags, 4);
+	splay_put_le(&header[8], count, 8);
+	splay_put_le(&header[16], size, 8);
+
+	if (fwrite(header, sizeof(header), 1, fp) != 1)
+		return -1;
+
+	record = (unsigned char *)malloc(size ? size : 1);
+	if (!record)
+		return -1;
+
+	if (flags & SPLAY_SERIALIZE_SHAPE) {
+		for (node = root->node; node; node = splay_preorder_next(node)) {
+			if (node->left)
+				bits |= 1u << nbits;
+			if (node->right)
+				bits |= 2u << nbits;
+			nbits += 2;
+
+			if (nbits < 8)
+				continue;
+
+			if (fputc((int)bits, fp) == EOF)
+				goto out;
+
+			bits = 0;
+			nbits = 0;
+		}
+
+		if (nbits && fputc((int)bits, fp) == EOF)
+			goto out;
+
+		node = root->node;
+	} else {
+		node = splay_first(root);
+	}
+
+	while (node) {
+		store(record, node, priv);
+		if (size && fwrite(record, size, 1, fp) != 1)
+			goto out;
+
+		if (flags & SPLAY_SERIALIZE_SHAPE)
+			node = splay_preorder_next(node);
+		else
+			node = splay_next(node);
+	}
+
+	ret = 0;
+out:
+	free(record);
+	return ret;
+}
+
+/**
+ * splay_deserialize_shape() - Rebuild exact tree from preorder records
+ * @root: pointer to splay root
+ * @fp: file to read from
+ * @record: buffer for a single record
+ * @size: size of each record
+ * @count: number of records
+ * @load: callback which returns the node for a record
+ * @priv: private data for @load
+ *
+ * Nodes which still wait for their right subtree are marked with a pending
+ * right pointer. The next free position is searched by going upwards from the
+ * last leaf. Each node is passed at most once this way.
+ *
+ * Return: 0 on success, -1 on errors
+ */
+static int splay_deserialize_shape(struct splay_root *root, FILE *fp,
+				   unsigned char *record, size_t size,
+				   size_t count,
+				   struct splay_node *(*load)(const void *record,
+							      void *priv),
+				   void *priv)
+{
+	static struct splay_node pending;
+	struct splay_node **splay_link = &root->node;
+	struct splay_node *parent = NULL;
+	struct splay_node *node;
+	unsigned char *shape;
+	size_t shape_len;
+	unsigned int bits;
+	int ret = -1;
+	size_t i;
+
+	shape_len = (2 * count + 7) / 8;
+	shape = (unsigned char *)malloc(shape_len);
+	if (!shape)
+		return -1;
+
+	if (fread(shape, shape_len, 1, fp) != 1)
+		goto out;
+
+	for (i = 0; i < count; i++) {
+		/* no free position left in tree */
+		if (!splay_link)
+			goto out;
+
+		if (size && fread(record, size, 1, fp) != 1)
+			goto out;
+
+		node = load(record, priv);
+		if (!node)
+			goto out;
+
+		splay_link_node(node, parent, splay_link);
+
+		bits = shape[(2 * i) / 8] >> ((2 * i) % 8);
+		if (bits & 2)
+			node->right = &pending;
+
+		if (bits & 1) {
+			parent = node;
+			splay_link = &node->left;
+			continue;
+		}
+
+		if (bits & 2) {
+			parent = node;
+			splay_link = &node->right;
+			continue;
+		}
+
+		/* leaf - search next pending right subtree */
+		parent = node->parent;
+		while (parent && parent->right != &pending)
+			parent = parent->parent;
+
+		if (parent)
+			splay_link = &parent->right;
+		else
+			splay_link = NULL;
+	}
+
+	/* shape expects more nodes */
+	if (splay_link)
+		goto out;
+
+	ret = 0;
+out:
+	free(shape);
+	return ret;
+}
+
+/**
+ * splay_deserialize() - Rebuild tree from a file written by splay_serialize
+ * @root: pointer to splay root
+ * @fp: file to read from
+ * @size: size of each record, must match the one used in splay_serialize
+ * @load: callback which returns the node for a record
+ * @priv: private data for @load
+ *
+ * The file is read sequentially and each node is linked directly into its
+ * final position in O(n). No comparisons or splaying is done. The exact tree
+ * is rebuilt when it was serialized with SPLAY_SERIALIZE_SHAPE. A balanced
+ * tree is built otherwise.
+ *
+ * The tree in @root is overwritten and must not contain any nodes. @root is
+ * empty when an error occurred. The nodes returned by @load up to this point
+ * must then be released by the caller.
+ *
+ * Return: 0 on success, -1 on errors
+ */
+int splay_deserialize(struct splay_root *root, FILE *fp, size_t size,
+		      struct splay_node *(*load)(const void *record,
+						 void *priv),
+		      void *priv)
+{
+	unsigned char header[SPLAY_SERIALIZE_HEADER_LEN];
+	struct splay_build_state state;
+	struct splay_node *node;
+	unsigned char *record;
+	unsigned int flags;
+	uint64_t count;
+	int ret = -1;
+	size_t i;
+
+	root->node = NULL;
+
+	if (fread(header, sizeof(header), 1, fp) != 1)
+		return -1;
+
+	if (memcmp(header, splay_serialize_magic,
+		   sizeof(splay_serialize_magic)) != 0)
+		return -1;
+
+	flags = (unsigned int)splay_get_le(&header[4], 4);
+	count = splay_get_le(&header[8], 8);
+	if (count > SIZE_MAX / 8)
+		return -1;
+
+	if (splay_get_le(&header[16], 8) != size)
+		return -1;
+
+	if (count == 0)
+		return 0;
+
+	record = (unsigned char *)malloc(size ? size : 1);
+	if (!record)
+		return -1;
+
+	if (flags & SPLAY_SERIALIZE_SHAPE) {
+		ret = splay_deserialize_shape(root, fp, record, size,
+					      (size_t)count, load, priv);
+		goto out;
+	}
+
+	splay_build_init(&state, (size_t)count);
+	for (i = 0; i < count; i++) {
+		if (size && fread(record, size, 1, fp) != 1)
+			goto out;
+
+		node = load(record, priv);
+		if (!node)
+			goto out;
+
+		splay_build_add(&state, node, root);
+	}
+
+	ret = 0;
+out:
+	free(record);
+	if (ret < 0)
+		root->node = NULL;
+
+	return ret;
+}
+
+/**
+ * splay_off_change_child() - Fix child entry of parent node
+ * @old_node: splay node to replace
+ * @new_node: splay node replacing @old_node
+ * @parent: parent of @old_node
+ * @root: pointer to splay root
+ *
+ * Detects if @old_node is left/right child of @parent or if it gets inserted
+ * as as new root. These entries are then updated to point to @new_node.
+ *
+ * @old_node and @root must not be NULL.
+ */
+static void splay_off_change_child(struct splay_off_node *old_node,
+				   struct splay_off_node *new_node,
+				   struct splay_off_node *parent,
+				   struct splay_off_root *root)
+{
+	if (parent) {
+		if (splay_off_get(&parent->left) == old_node)
+			splay_off_set(&parent->left, new_node);
+		else
+			splay_off_set(&parent->right, new_node);
+	} else {
+		splay_off_set(&root->node, new_node);
+	}
+}
+
+/**
+ * splay_off_rotate_switch_parents() - set parent for switched nodes
+ * @node_top: splay node which became the new top node
+ * @node_child: splay node which became the new child node
+ * @node_child2: ex'child of @node_top which now is now 2. child of @node_child
+ * @root: pointer to splay root
+ *
+ * See splay_rotate_switch_parents.
+ */
+static void splay_off_rotate_switch_parents(struct splay_off_node *node_top,
+					    struct splay_off_node *node_child,
+					    struct splay_off_node *node_child2,
+					    struct splay_off_root *root)
+{
+	struct splay_off_node *parent = splay_off_get(&node_child->parent);
+
+	/* switch parents */
+	splay_off_set(&node_top->parent, parent);
+	splay_off_set(&node_child->parent, node_top);
+
+	/* switch parent of child2 from child to top */
+	if (node_child2)
+		splay_off_set(&node_child2->parent, node_child);
+
+	/* parent of node_top must get its child pointer get fixed */
+	splay_off_change_child(node_child, node_top, parent, root);
+}
+
+/**
+ * splay_off_is_right_child() - Check if the node is a right child
+ * @node: splay node to check
+ *
+ * Return: true when @node is a right child, false when it is a left child or
+ *  when it has no parent
+ */
+static bool splay_off_is_right_child(struct splay_off_node *node)
+{
+	struct splay_off_node *parent = splay_off_get(&node->parent);
+
+	if (!parent)
+		return false;
+
+	if (splay_off_get(&parent->right) == node)
+		return true;
+
+	return false;
+}
+
+/**
+ * splay_off_rotate_left() - Rotate subtree at @parent to the left
+ * @parent: root of the subtree to rotate to the left
+ * @root: pointer to splay root
+ */
+static void splay_off_rotate_left(struct splay_off_node *parent,
+				  struct splay_off_root *root)
+{
+	struct splay_off_node *tmp;
+	struct splay_off_node *child2;
+
+	/* rotate left */
+	tmp = splay_off_get(&parent->right);
+	child2 = splay_off_get(&tmp->left);
+	splay_off_set(&parent->right, child2);
+	splay_off_set(&tmp->left, parent);
+
+	splay_off_rotate_switch_parents(tmp, parent, child2, root);
+}
+
+/**
+ * splay_off_rotate_right() - Rotate subtree at @parent to the right
+ * @parent: root of the subtree to rotate to the right
+ * @root: pointer to splay root
+ */
+static void splay_off_rotate_right(struct splay_off_node *parent,
+				   struct splay_off_root *root)
+{
+	struct splay_off_node *tmp;
+	struct splay_off_node *child2;
+
+	/* rotate right */
+	tmp = splay_off_get(&parent->left);
+	child2 = splay_off_get(&tmp->right);
+	splay_off_set(&parent->left, child2);
+	splay_off_set(&tmp->right, parent);
+
+	splay_off_rotate_switch_parents(tmp, parent, child2, root);
+}
+
+/**
+ * splay_off_splaying() - Go tree upwards and splay @node to the root
+ * @node: pointer to the new node
+ * @root: pointer to splay root
+ *
+ * The tree is traversed from bottom to the top starting at @node. The @node
+ * will be moved upwards towards the @root of the tree.
+ */
+void splay_off_splaying(struct splay_off_node *node,
+			struct splay_off_root *root)
+{
+	struct splay_off_node *parent;
+	struct splay_off_node *grandparent;
+
+	while ((parent = splay_off_get(&node->parent))) {
+		grandparent = splay_off_get(&parent->parent);
+		if (!grandparent) {
+			/* zig step */
+			if (splay_off_is_right_child(node))
+				splay_off_rotate_left(parent, root);
+			else
+				splay_off_rotate_right(parent, root);
+		} else {
+			if (splay_off_is_right_child(node)) {
+				if (splay_off_is_right_child(parent)) {
+					/* zig-zig step */
+					splay_off_rotate_left(grandparent,
+							      root);
+					splay_off_rotate_left(parent, root);
+				} else {
+					/* zig-zag step */
+					splay_off_rotate_left(parent, root);
+					splay_off_rotate_right(grandparent,
+							       root);
+				}
+			} else {
+				if (splay_off_is_right_child(parent)) {
+					/* zig-zag step */
+					splay_off_rotate_right(parent, root);
+					splay_off_rotate_left(grandparent,
+							      root);
+				} else {
+					/* zig-zig step */
+					splay_off_rotate_right(grandparent,
+							       root);
+					splay_off_rotate_right(parent, root);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * splay_off_erase_node() - Remove splay node from tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * See splay_erase_node.
+ *
+ * Return: parent of the removed node, NULL if no parent is available
+ */
+struct splay_off_node *splay_off_erase_node(struct splay_off_node *node,
+					    struct splay_off_root *root)
+{
+	struct splay_off_node *parent = splay_off_get(&node->parent);
+	struct splay_off_node *left = splay_off_get(&node->left);
+	struct splay_off_node *right = splay_off_get(&node->right);
+	struct splay_off_node *smallest;
+	struct splay_off_node *smallest_parent;
+	struct splay_off_node *smallest_right;
+	struct splay_off_node *decreased_node;
+
+	if (!left && !right) {
+		/* no child
+		 * just delete the current child
+		 */
+		splay_off_change_child(node, NULL, parent, root);
+
+		return parent;
+	} else if (left && !right) {
+		/* one child, left
+		 * use left child as replacement for the deleted node
+		 */
+		splay_off_set(&left->parent, parent);
+		splay_off_change_child(node, left, parent, root);
+
+		return parent;
+	} else if (!left) {
+		/* one child, right
+		 * use right child as replacement for the deleted node
+		 */
+		splay_off_set(&right->parent, parent);
+		splay_off_change_child(node, right, parent, root);
+
+		return parent;
+	}
+
+	/* two children, take smallest of right (grand)children */
+	smallest = right;
+	while (splay_off_get(&smallest->left))
+		smallest = splay_off_get(&smallest->left);
+
+	smallest_parent = splay_off_get(&smallest->parent);
+	if (smallest == right)
+		decreased_node = right;
+	else
+		decreased_node = smallest_parent;
+
+	/* move right child of smallest one up */
+	smallest_right = splay_off_get(&smallest->right);
+	if (smallest_right)
+		splay_off_set(&smallest_right->parent, smallest_parent);
+	splay_off_change_child(smallest, smallest_right, smallest_parent, root);
+
+	/* right child of node might have changed by moving smallest */
+	right = splay_off_get(&node->right);
+
+	/* exchange node with smallest */
+	splay_off_set(&smallest->parent, parent);
+
+	splay_off_set(&smallest->left, left);
+	splay_off_set(&left->parent, smallest);
+
+	splay_off_set(&smallest->right, right);
+	if (right)
+		splay_off_set(&right->parent, smallest);
+
+	splay_off_change_child(node, smallest, parent, root);
+
+	return decreased_node;
+}
+
+/**
+ * splay_off_first() - Find leftmost splay node in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to leftmost node. NULL when @root is empty.
+ */
+struct splay_off_node *splay_off_first(const struct splay_off_root *root)
+{
+	struct splay_off_node *node = splay_off_get(&root->node);
+
+	if (!node)
+		return node;
+
+	/* descend down via smaller/preceding child */
+	while (node->left)
+		node = splay_off_get(&node->left);
+
+	return node;
+}
+
+/**
+ * splay_off_last() - Find rightmost splay node in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to rightmost node. NULL when @root is empty.
+ */
+struct splay_off_node *splay_off_last(const struct splay_off_root *root)
+{
+	struct splay_off_node *node = splay_off_get(&root->node);
+
+	if (!node)
+		return node;
+
+	/* descend down via larger/succeeding child */
+	while (node->right)
+		node = splay_off_get(&node->right);
+
+	return node;
+}
+
+/**
+ * splay_off_next() - Find successor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to successor node. NULL when no successor of @node exist.
+ */
+struct splay_off_node *splay_off_next(struct splay_off_node *node)
+{
+	struct splay_off_node *parent;
+
+	/* there is a right child - next node must be the leftmost under it */
+	if (node->right) {
+		node = splay_off_get(&node->right);
+		while (node->left)
+			node = splay_off_get(&node->left);
+
+		return node;
+	}
+
+	/* go up the tree until the path connecting both is the left child
+	 * pointer and therefore the parent is the next node
+	 */
+	parent = splay_off_get(&node->parent);
+	while (parent && splay_off_get(&parent->right) == node) {
+		node = parent;
+		parent = splay_off_get(&node->parent);
+	}
+
+	return parent;
+}
+
+/**
+ * splay_off_prev() - Find predecessor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to predecessor node. NULL when no predecessor of @node exist.
+ */
+struct splay_off_node *splay_off_prev(struct splay_off_node *node)
+{
+	struct splay_off_node *parent;
+
+	/* there is a left child - prev node must be the rightmost under it */
+	if (node->left) {
+		node = splay_off_get(&node->left);
+		while (node->right)
+			node = splay_off_get(&node->right);
+
+		return node;
+	}
+
+	/* go up the tree until the path connecting both is the right child
+	 * pointer and therefore the parent is the prev node
+	 */
+	parent = splay_off_get(&node->parent);
+	while (parent && splay_off_get(&parent->left) == node) {
+		node = parent;
+		parent = splay_off_get(&node->parent);
+	}
+
+	return parent;
+}
+
+/**
+ * splay_dir_change_child() - Set child entry of parent node
+ * @new_node: splay node which should be linked
+ * @parent: parent which should link to @new_node, NULL for root
+ * @dir: index of @new_node in the child array of @parent
+ * @root: pointer to splay root
+ *
+ * The parent link of @new_node is not modified.
+ */
+static void splay_dir_change_child(struct splay_dir_node *new_node,
+				   struct splay_dir_node *parent,
+				   unsigned int dir,
+				   struct splay_dir_root *root)
+{
+	if (parent)
+		parent->child[dir] = new_node;
+	else
+		root->node = new_node;
+}
+
+/**
+ * splay_dir_rotate() - Rotate @node above its parent
+ * @node: child of the root of the subtree to rotate
+ * @dir: child index of @node in its parent
+ * @root: pointer to splay root
+ *
+ * A left child (@dir is SPLAY_DIR_LEFT) causes a right rotation at the
+ * parent and a right child (@dir is SPLAY_DIR_RIGHT) a left rotation.
+ */
+static void splay_dir_rotate(struct splay_dir_node *node, unsigned int dir,
+			     struct splay_dir_root *root)
+{
+	struct splay_dir_node *parent = splay_dir_parent(node);
+	struct splay_dir_node *top = splay_dir_parent(parent);
+	unsigned int top_dir = splay_dir_side(parent);
+	struct splay_dir_node *child2 = node->child[!dir];
+
+	parent->child[dir] = child2;
+	if (child2)
+		splay_dir_set_parent(child2, parent, dir);
+
+	node->child[!dir] = parent;
+	splay_dir_set_parent(parent, node, !dir);
+
+	splay_dir_set_parent(node, top, top_dir);
+	splay_dir_change_child(node, top, top_dir, root);
+}
+
+/**
+ * splay_dir_zig_zig() - Move outer grandchild to grandparent position
+ * @node: child of @parent with index @dir
+ * @parent: child of @grandparent with index @dir
+ * @grandparent: root of the subtree to restructure
+ * @dir: child index of @node and @parent
+ * @root: pointer to splay root
+ *
+ * See splay_zig_zig_left and splay_zig_zig_right.
+ */
+static void splay_dir_zig_zig(struct splay_dir_node *node,
+			      struct splay_dir_node *parent,
+			      struct splay_dir_node *grandparent,
+			      unsigned int dir, struct splay_dir_root *root)
+{
+	struct splay_dir_node *top = splay_dir_parent(grandparent);
+	unsigned int top_dir = splay_dir_side(grandparent);
+	struct splay_dir_node *child_b = node->child[!dir];
+	struct splay_dir_node *child_c = parent->child[!dir];
+
+	grandparent->child[dir] = child_c;
+	if (child_c)
+		splay_dir_set_parent(child_c, grandparent, dir);
+
+	parent->child[dir] = child_b;
+	if (child_b)
+		splay_dir_set_parent(child_b, parent, dir);
+
+	parent->child[!dir] = grandparent;
+	splay_dir_set_parent(grandparent, parent, !dir);
+
+	node->child[!dir] = parent;
+	splay_dir_set_parent(parent, node, !dir);
+
+	splay_dir_set_parent(node, top, top_dir);
+	splay_dir_change_child(node, top, top_dir, root);
+}
+
+/**
+ * splay_dir_zig_zag() - Move inner grandchild to grandparent position
+ * @node: child of @parent with index @dir
+ * @parent: child of @grandparent with the opposite index of @dir
+ * @grandparent: root of the subtree to restructure
+ * @dir: child index of @node
+ * @root: pointer to splay root
+ *
+ * See splay_zig_zag_left and splay_zig_zag_right.
+ */
+static void splay_dir_zig_zag(struct splay_dir_node *node,
+			      struct splay_dir_node *parent,
+			      struct splay_dir_node *grandparent,
+			      unsigned int dir, struct splay_dir_root *root)
+{
+	struct splay_dir_node *top = splay_dir_parent(grandparent);
+	unsigned int top_dir = splay_dir_side(grandparent);
+	struct splay_dir_node *child_b = node->child[!dir];
+	struct splay_dir_node *child_c = node->child[dir];
+
+	parent->child[dir] = child_b;
+	if (child_b)
+		splay_dir_set_parent(child_b, parent, dir);
+
+	grandparent->child[!dir] = child_c;
+	if (child_c)
+		splay_dir_set_parent(child_c, grandparent, !dir);
+
+	node->child[!dir] = parent;
+	splay_dir_set_parent(parent, node, !dir);
+
+	node->child[dir] = grandparent;
+	splay_dir_set_parent(grandparent, node, dir);
+
+	splay_dir_set_parent(node, top, top_dir);
+	splay_dir_change_child(node, top, top_dir, root);
+}
+
+/**
+ * splay_dir_splaying() - Go tree upwards and splay @node to the root
+ * @node: pointer to the new node
+ * @root: pointer to splay root
+ *
+ * See splay_splaying. The sides of @node and its parent are taken from the
+ * tagged parent pointers. The child pointers of the parent and grandparent
+ * are therefore not loaded to select the step.
+ */
+void splay_dir_splaying(struct splay_dir_node *node,
+			struct splay_dir_root *root)
+{
+	struct splay_dir_node *parent;
+	struct splay_dir_node *grandparent;
+	unsigned int dir;
+	size_t depth = 0;
+
+	while ((parent = splay_dir_parent(node))) {
+		grandparent = splay_dir_parent(parent);
+		dir = splay_dir_side(node);
+
+		if (!grandparent) {
+			/* zig step */
+			splay_stats_add(root, zig, 1);
+			depth += 1;
+			splay_dir_rotate(node, dir, root);
+		} else if (splay_dir_side(parent) == dir) {
+			/* zig-zig step */
+			splay_stats_add(root, zigzig, 1);
+			depth += 2;
+			splay_dir_zig_zig(node, parent, grandparent, dir, root);
+		} else {
+			/* zig-zag step */
+			splay_stats_add(root, zigzag, 1);
+			depth += 2;
+			splay_dir_zig_zag(node, parent, grandparent, dir, root);
+		}
+	}
+
+	splay_stats_depth(&root->stats, depth);
+}
+
+/**
+ * splay_dir_erase_node() - Remove splay node from tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * See splay_erase_node.
+ *
+ * Return: parent of the removed node, NULL if no parent is available
+ */
+struct splay_dir_node *splay_dir_erase_node(struct splay_dir_node *node,
+					    struct splay_dir_root *root)
+{
+	struct splay_dir_node *parent = splay_dir_parent(node);
+	unsigned int dir = splay_dir_side(node);
+	struct splay_dir_node *left = node->child[SPLAY_DIR_LEFT];
+	struct splay_dir_node *right = node->child[SPLAY_DIR_RIGHT];
+	struct splay_dir_node *replacement;
+	struct splay_dir_node *smallest;
+	struct splay_dir_node *smallest_parent;
+	struct splay_dir_node *smallest_right;
+	struct splay_dir_node *decreased_node;
+	unsigned int smallest_dir;
+
+	if (!left || !right) {
+		/* no child or one child
+		 * use the (maybe missing) child as replacement for the deleted
+		 * node. It is the right child when there is no left child
+		 */
+		replacement = node->child[!left];
+		if (replacement) {
+			splay_stats_add(root, erase_one_child, 1);
+			splay_dir_set_parent(replacement, parent, dir);
+		} else {
+			splay_stats_add(root, erase_leaf, 1);
+		}
+		splay_dir_change_child(replacement, parent, dir, root);
+
+		return parent;
+	}
+
+	/* two children, take smallest of right (grand)children */
+	splay_stats_add(root, erase_two_children, 1);
+	smallest = right;
+	while (smallest->child[SPLAY_DIR_LEFT])
+		smallest = smallest->child[SPLAY_DIR_LEFT];
+
+	smallest_parent = splay_dir_parent(smallest);
+	smallest_dir = splay_dir_side(smallest);
+	if (smallest == right)
+		decreased_node = right;
+	else
+		decreased_node = smallest_parent;
+
+	/* move right child of smallest one up */
+	smallest_right = smallest->child[SPLAY_DIR_RIGHT];
+	if (smallest_right)
+		splay_dir_set_parent(smallest_right, smallest_parent,
+				     smallest_dir);
+	splay_dir_change_child(smallest_right, smallest_parent, smallest_dir,
+			       root);
+
+	/* right child of node might have changed by moving smallest */
+	right = node->child[SPLAY_DIR_RIGHT];
+
+	/* exchange node with smallest */
+	splay_dir_set_parent(smallest, parent, dir);
+
+	smallest->child[SPLAY_DIR_LEFT] = left;
+	splay_dir_set_parent(left, smallest, SPLAY_DIR_LEFT);
+
+	smallest->child[SPLAY_DIR_RIGHT] = right;
+	if (right)
+		splay_dir_set_parent(right, smallest, SPLAY_DIR_RIGHT);
+
+	splay_dir_change_child(smallest, parent, dir, root);
+
+	return decreased_node;
+}
+
+/**
+ * splay_dir_replace() - Replace node in tree with a node outside the tree
+ * @old_node: pointer to the node in the tree
+ * @new_node: pointer to the node which takes the position of @old_node
+ * @root: pointer to splay root
+ *
+ * @new_node takes over the parent and children of @old_node. The caller has to
+ * make sure that the order of the tree is not changed by this operation.
+ * @old_node is no longer part of the tree afterwards.
+ */
+void splay_dir_replace(struct splay_dir_node *old_node,
+		       struct splay_dir_node *new_node,
+		       struct splay_dir_root *root)
+{
+	struct splay_dir_node *parent = splay_dir_parent(old_node);
+	unsigned int dir = splay_dir_side(old_node);
+	struct splay_dir_node *child;
+	unsigned int i;
+
+	*new_node = *old_node;
+
+	for (i = 0; i < 2; i++) {
+		child = new_node->child[i];
+		if (child)
+			splay_dir_set_parent(child, new_node, i);
+	}
+
+	splay_dir_change_child(new_node, parent, dir, root);
+}
+
+/**
+ * splay_dir_end() - Find outermost splay node in tree
+ * @root: pointer to splay root
+ * @dir: SPLAY_DIR_LEFT for the leftmost, SPLAY_DIR_RIGHT for the rightmost
+ *  node
+ *
+ * Return: pointer to outermost node. NULL when @root is empty.
+ */
+struct splay_dir_node *splay_dir_end(const struct splay_dir_root *root,
+				     enum splay_dir dir)
+{
+	struct splay_dir_node *node = root->node;
+
+	if (!node)
+		return node;
+
+	/* descend down via outer child */
+	while (node->child[dir])
+		node = node->child[dir];
+
+	return node;
+}
+
+/**
+ * splay_dir_step() - Find neighbor node in tree
+ * @node: starting splay node for search
+ * @dir: SPLAY_DIR_RIGHT for the successor, SPLAY_DIR_LEFT for the
+ *  predecessor
+ *
+ * Return: pointer to neighbor node. NULL when no neighbor of @node exist.
+ */
+struct splay_dir_node *splay_dir_step(struct splay_dir_node *node,
+				      enum splay_dir dir)
+{
+	/* there is a child in @dir - neighbor must be the innermost under it */
+	if (node->child[dir]) {
+		node = node->child[dir];
+		while (node->child[!dir])
+			node = node->child[!dir];
+
+		return node;
+	}
+
+	/* go up the tree until the path connecting both is the opposite child
+	 * pointer and therefore the parent is the neighbor node. The side is
+	 * stored in the node itself - parents are only loaded to go up
+	 */
+	while (node->parent_side && splay_dir_side(node) == dir)
+		node = splay_dir_parent(node);
+
+	return splay_dir_parent(node);
+}
+
+/**
+ * splay_seq_node_size() - Get number of nodes in subtree
+ * @node: root of the subtree, can be NULL
+ *
+ * Return: number of nodes in the subtree, 0 when @node is NULL
+ */
+static size_t splay_seq_node_size(const struct splay_seq_node *node)
+{
+	if (!node)
+		return 0;
+
+	return node->size;
+}
+
+/**
+ * splay_seq_update() - Recalculate subtree data of node
+ * @node: node with up-to-date children
+ * @root: pointer to splay root
+ */
+static void splay_seq_update(struct splay_seq_node *node,
+			     const struct splay_seq_root *root)
+{
+	node->size = 1 + splay_seq_node_size(node->child[SPLAY_DIR_LEFT]) +
+		     splay_seq_node_size(node->child[SPLAY_DIR_RIGHT]);
+
+	if (root->ops && root->ops->update)
+		root->ops->update(node);
+}
+
+/**
+ * splay_seq_push() - Move pending updates of node to its children
+ * @node: node which is about to be visited, can be NULL
+ * @root: pointer to splay root
+ */
+static void splay_seq_push(struct splay_seq_node *node,
+			   const struct splay_seq_root *root)
+{
+	struct splay_seq_node *tmp;
+
+	if (!node)
+		return;
+
+	if (node->reversed) {
+		tmp = node->child[SPLAY_DIR_LEFT];
+		node->child[SPLAY_DIR_LEFT] = node->child[SPLAY_DIR_RIGHT];
+		node->child[SPLAY_DIR_RIGHT] = tmp;
+
+		if (node->child[SPLAY_DIR_LEFT])
+			node->child[SPLAY_DIR_LEFT]->reversed ^= 1;
+		if (node->child[SPLAY_DIR_RIGHT])
+			node->child[SPLAY_DIR_RIGHT]->reversed ^= 1;
+
+		node->reversed = 0;
+	}
+
+	if (root->ops && root->ops->push)
+		root->ops->push(node);
+}
+
+/**
+ * splay_seq_push_path() - Move pending updates down to node
+ * @node: node which is about to be accessed
+ * @root: pointer to splay root
+ *
+ * The updates have to be pushed top-down from the root to @node. The path is
+ * found without extra memory by reversing the parent pointers on the way up
+ * and restoring them on the way down.
+ */
+static void splay_seq_push_path(struct splay_seq_node *node,
+				const struct splay_seq_root *root)
+{
+	struct splay_seq_node *prev = NULL;
+	struct splay_seq_node *next;
+
+	while (node) {
+		next = node->parent;
+		node->parent = prev;
+		prev = node;
+		node = next;
+	}
+
+	node = prev;
+	prev = NULL;
+	while (node) {
+		splay_seq_push(node, root);
+
+		next = node->parent;
+		node->parent = prev;
+		prev = node;
+		node = next;
+	}
+}
+
+/**
+ * splay_seq_side() - Get child index of a node in its parent
+ * @node: splay node with parent
+ *
+ * Return: SPLAY_DIR_RIGHT when @node is the right child of its parent,
+ *  SPLAY_DIR_LEFT when it is the left child
+ */
+static unsigned int splay_seq_side(const struct splay_seq_node *node)
+{
+	return node->parent->child[SPLAY_DIR_RIGHT] == node;
+}
+
+/**
+ * splay_seq_rotate() - Rotate @node above its parent
+ * @node: child of the root of the subtree to rotate
+ * @root: pointer to splay root
+ *
+ * The subtree data of @node and its former parent are updated.
+ */
+static void splay_seq_rotate(struct splay_seq_node *node,
+			     struct splay_seq_root *root)
+{
+	struct splay_seq_node *parent = node->parent;
+	struct splay_seq_node *top = parent->parent;
+	unsigned int dir = splay_seq_side(node);
+	struct splay_seq_node *child2 = node->child[!dir];
+
+	parent->child[dir] = child2;
+	if (child2)
+		child2->parent = parent;
+
+	node->child[!dir] = parent;
+	parent->parent = node;
+
+	node->parent = top;
+	if (top)
+		top->child[top->child[SPLAY_DIR_RIGHT] == parent] = node;
+	else
+		root->node = node;
+
+	splay_seq_update(parent, root);
+	splay_seq_update(node, root);
+}
+
+/**
+ * splay_seq_splaying_pushed() - Splay node without pending updates on path
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * All nodes from the root to @node must already be pushed.
+ */
+static void splay_seq_splaying_pushed(struct splay_seq_node *node,
+				      struct splay_seq_root *root)
+{
+	struct splay_seq_node *parent;
+
+	while ((parent = node->parent)) {
+		if (!parent->parent) {
+			/* zig step */
+			splay_seq_rotate(node, root);
+		} else if (splay_seq_side(node) == splay_seq_side(parent)) {
+			/* zig-zig step */
+			splay_seq_rotate(parent, root);
+			splay_seq_rotate(node, root);
+		} else {
+			/* zig-zag step */
+			splay_seq_rotate(node, root);
+			splay_seq_rotate(node, root);
+		}
+	}
+}
+
+/**
+ * splay_seq_splaying() - Go tree upwards and splay @node to the root
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * See splay_splaying. Pending updates on the path to @node are pushed first
+ * and the subtree data is updated during the rotations.
+ */
+void splay_seq_splaying(struct splay_seq_node *node,
+			struct splay_seq_root *root)
+{
+	splay_seq_push_path(node, root);
+	splay_seq_splaying_pushed(node, root);
+}
+
+/**
+ * splay_seq_at() - Search node at position in sequence
+ * @root: pointer to splay root
+ * @index: 0-based position of the node
+ *
+ * The found node is splayed to the root of the tree.
+ *
+ * Return: node at position @index, NULL when @index is not smaller than the
+ *  size of the sequence
+ */
+struct splay_seq_node *splay_seq_at(struct splay_seq_root *root,
+				    size_t index)
+{
+	struct splay_seq_node *node = root->node;
+	size_t left_size;
+
+	if (index >= splay_seq_size(root))
+		return NULL;
+
+	while (node) {
+		splay_seq_push(node, root);
+
+		left_size = splay_seq_node_size(node->child[SPLAY_DIR_LEFT]);
+		if (index == left_size)
+			break;
+
+		if (index < left_size) {
+			node = node->child[SPLAY_DIR_LEFT];
+		} else {
+			index -= left_size + 1;
+			node = node->child[SPLAY_DIR_RIGHT];
+		}
+	}
+
+	splay_seq_splaying_pushed(node, root);
+
+	return node;
+}
+
+/**
+ * splay_seq_index() - Get position of node in sequence
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * @node is splayed to the root of the tree.
+ *
+ * Return: 0-based position of @node
+ */
+size_t splay_seq_index(struct splay_seq_node *node,
+		       struct splay_seq_root *root)
+{
+	splay_seq_splaying(node, root);
+
+	return splay_seq_node_size(node->child[SPLAY_DIR_LEFT]);
+}
+
+/**
+ * splay_seq_insert_at() - Add new node at position in sequence
+ * @node: pointer to the new node
+ * @index: 0-based position of the new node
+ * @root: pointer to splay root
+ *
+ * The nodes starting at position @index are moved one position back. @index
+ * can be the size of the sequence to append @node. @node is the new root of
+ * the tree. The user data of @node must be initialized before it is
+ * inserted.
+ *
+ * Return: 0 on success, -1 when @index is larger than the size of the sequence
+ */
+int splay_seq_insert_at(struct splay_seq_node *node, size_t index,
+			struct splay_seq_root *root)
+{
+	size_t size = splay_seq_size(root);
+	struct splay_seq_node *cur;
+	struct splay_seq_node *left;
+
+	if (index > size)
+		return -1;
+
+	node->parent = NULL;
+	node->child[SPLAY_DIR_LEFT] = NULL;
+	node->child[SPLAY_DIR_RIGHT] = NULL;
+	node->reversed = 0;
+
+	if (index == size) {
+		/* previous last node becomes the left child */
+		if (size) {
+			cur = splay_seq_at(root, size - 1);
+			node->child[SPLAY_DIR_LEFT] = cur;
+			cur->parent = node;
+		}
+	} else {
+		/* node at index becomes the right child, its left subtree
+		 * is moved to the new node
+		 */
+		cur = splay_seq_at(root, index);
+		left = cur->child[SPLAY_DIR_LEFT];
+		cur->child[SPLAY_DIR_LEFT] = NULL;
+		splay_seq_update(cur, root);
+
+		node->child[SPLAY_DIR_LEFT] = left;
+		if (left)
+			left->parent = node;
+
+		node->child[SPLAY_DIR_RIGHT] = cur;
+		cur->parent = node;
+	}
+
+	splay_seq_update(node, root);
+	root->node = node;
+
+	return 0;
+}
+
+/**
+ * splay_seq_erase() - Remove node from sequence
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ *
+ * The nodes after @node are moved one position forward.
+ */
+void splay_seq_erase(struct splay_seq_node *node,
+		     struct splay_seq_root *root)
+{
+	struct splay_seq_root right;
+
+	splay_seq_splaying(node, root);
+
+	root->node = node->child[SPLAY_DIR_LEFT];
+	if (root->node)
+		root->node->parent = NULL;
+
+	right.node = node->child[SPLAY_DIR_RIGHT];
+	right.ops = root->ops;
+	if (right.node)
+		right.node->parent = NULL;
+
+	splay_seq_join(root, &right);
+}
+
+/**
+ * splay_seq_erase_at() - Remove node at position from sequence
+ * @index: 0-based position of the node
+ * @root: pointer to splay root
+ *
+ * Return: removed node, NULL when @index is not smaller than the size of the
+ *  sequence
+ */
+struct splay_seq_node *splay_seq_erase_at(size_t index,
+					  struct splay_seq_root *root)
+{
+	struct splay_seq_node *node;
+
+	node = splay_seq_at(root, index);
+	if (!node)
+		return NULL;
+
+	splay_seq_erase(node, root);
+
+	return node;
+}
+
+/**
+ * splay_seq_split() - Split sequence at position
+ * @root: pointer to splay root of the sequence to split
+ * @index: 0-based position of the first node which is moved to @right
+ * @right: pointer to splay root which receives the nodes starting at @index
+ *
+ * The first @index nodes stay in @root. @right is initialized by this
+ * function with the callbacks of @root and must not contain any nodes.
+ */
+void splay_seq_split(struct splay_seq_root *root, size_t index,
+		     struct splay_seq_root *right)
+{
+	struct splay_seq_node *node;
+	struct splay_seq_node *left;
+
+	INIT_SPLAY_SEQ_ROOT_OPS(right, root->ops);
+
+	if (index == 0) {
+		right->node = root->node;
+		root->node = NULL;
+		return;
+	}
+
+	node = splay_seq_at(root, index);
+	if (!node)
+		return;
+
+	left = node->child[SPLAY_DIR_LEFT];
+	node->child[SPLAY_DIR_LEFT] = NULL;
+	left->parent = NULL;
+	splay_seq_update(node, root);
+
+	root->node = left;
+	right->node = node;
+}
+
+/**
+ * splay_seq_join() - Append sequence to other sequence
+ * @root: pointer to splay root of the sequence to extend
+ * @right: pointer to splay root of the sequence to append
+ *
+ * All nodes of @right are moved to the end of @root. @right is empty
+ * afterwards. Both sequences must use the same callbacks.
+ */
+void splay_seq_join(struct splay_seq_root *root,
+		    struct splay_seq_root *right)
+{
+	struct splay_seq_node *last;
+
+	if (!right->node)
+		return;
+
+	if (!root->node) {
+		root->node = right->node;
+		right->node = NULL;
+		return;
+	}
+
+	/* the last node has no right child after being splayed to the root */
+	last = splay_seq_at(root, splay_seq_size(root) - 1);
+	last->child[SPLAY_DIR_RIGHT] = right->node;
+	right->node->parent = last;
+	splay_seq_update(last, root);
+
+	right->node = NULL;
+}
+
+/**
+ * splay_seq_cut() - Move slice of sequence to new sequence
+ * @root: pointer to splay root of the sequence to cut
+ * @index: 0-based position of the first node of the slice
+ * @count: maximum number of nodes in the slice
+ * @slice: pointer to splay root which receives the slice
+ *
+ * The slice is limited to the end of @root. @slice is initialized by this
+ * function with the callbacks of @root and must not contain any nodes.
+ */
+void splay_seq_cut(struct splay_seq_root *root, size_t index, size_t count,
+		   struct splay_seq_root *slice)
+{
+	struct splay_seq_root tail;
+
+	splay_seq_split(root, index, slice);
+	splay_seq_split(slice, count, &tail);
+	splay_seq_join(root, &tail);
+}
+
+/**
+ * splay_seq_splice() - Insert sequence at position in other sequence
+ * @root: pointer to splay root of the sequence to extend
+ * @index: 0-based position of the first inserted node
+ * @slice: pointer to splay root of the sequence to insert
+ *
+ * All nodes of @slice are moved to @root. @slice is empty afterwards. Both
+ * sequences must use the same callbacks.
+ *
+ * Return: 0 on success, -1 when @index is larger than the size of @root
+ */
+int splay_seq_splice(struct splay_seq_root *root, size_t index,
+		     struct splay_seq_root *slice)
+{
+	struct splay_seq_root tail;
+
+	if (index > splay_seq_size(root))
+		return -1;
+
+	splay_seq_split(root, index, &tail);
+	splay_seq_join(root, slice);
+	splay_seq_join(root, &tail);
+
+	return 0;
+}
+
+/**
+ * splay_seq_apply() - Apply lazy update to range of sequence
+ * @root: pointer to splay root
+ * @index: 0-based position of the first node of the range
+ * @count: maximum number of nodes in the range
+ * @apply: function which updates a subtree root and records the pending
+ *  update for its children (see struct splay_seq_ops)
+ * @arg: user data for @apply
+ *
+ * The range is cut out of the sequence so that a single subtree contains
+ * exactly its nodes. @apply is called once for the root of this subtree and
+ * the range is put back afterwards. The update therefore needs O(log n)
+ * amortized time independent of @count. @apply is not called for an empty
+ * range.
+ */
+void splay_seq_apply(struct splay_seq_root *root, size_t index, size_t count,
+		     void (*apply)(struct splay_seq_node *node, void *arg),
+		     void *arg)
+{
+	struct splay_seq_root slice;
+
+	splay_seq_cut(root, index, count, &slice);
+	if (!slice.node)
+		return;
+
+	apply(slice.node, arg);
+	splay_seq_splice(root, index, &slice);
+}
+
+/**
+ * splay_seq_reverse() - Reverse order of range of sequence
+ * @root: pointer to splay root
+ * @index: 0-based position of the first node of the range
+ * @count: maximum number of nodes in the range
+ *
+ * The reversal is recorded lazily at the root of the subtree which contains
+ * the range and needs O(log n) amortized time.
+ */
+void splay_seq_reverse(struct splay_seq_root *root, size_t index,
+		       size_t count)
+{
+	struct splay_seq_root slice;
+
+	splay_seq_cut(root, index, count, &slice);
+	if (!slice.node)
+		return;
+
+	slice.node->reversed ^= 1;
+	splay_seq_splice(root, index, &slice);
+}
+
+/**
+ * splay_seq_end() - Find outermost splay node in sequence
+ * @root: pointer to splay root
+ * @dir: SPLAY_DIR_LEFT for the first, SPLAY_DIR_RIGHT for the last node
+ *
+ * Return: pointer to outermost node. NULL when @root is empty.
+ */
+static struct splay_seq_node *splay_seq_end(struct splay_seq_root *root,
+					    unsigned int dir)
+{
+	struct splay_seq_node *node = root->node;
+
+	if (!node)
+		return node;
+
+	splay_seq_push(node, root);
+	while (node->child[dir]) {
+		node = node->child[dir];
+		splay_seq_push(node, root);
+	}
+
+	return node;
+}
+
+/**
+ * splay_seq_step() - Find neighbor node in sequence
+ * @node: starting splay node for search
+ * @dir: SPLAY_DIR_RIGHT for the next, SPLAY_DIR_LEFT for the previous node
+ * @root: pointer to splay root
+ *
+ * The children of a node are only valid after all pending updates above it
+ * were pushed. @node is therefore splayed to the root first. This also keeps
+ * a full iteration over the sequence at O(n) amortized time.
+ *
+ * Return: pointer to neighbor node. NULL when no neighbor of @node exist.
+ */
+static struct splay_seq_node *splay_seq_step(struct splay_seq_node *node,
+					     unsigned int dir,
+					     struct splay_seq_root *root)
+{
+	splay_seq_splaying(node, root);
+
+	node = node->child[dir];
+	if (!node)
+		return NULL;
+
+	splay_seq_push(node, root);
+	while (node->child[!dir]) {
+		node = node->child[!dir];
+		splay_seq_push(node, root);
+	}
+
+	return node;
+}
+
+/**
+ * splay_seq_first() - Find first node in sequence
+ * @root: pointer to splay root
+ *
+ * Return: pointer to first node. NULL when @root is empty.
+ */
+struct splay_seq_node *splay_seq_first(struct splay_seq_root *root)
+{
+	return splay_seq_end(root, SPLAY_DIR_LEFT);
+}
+
+/**
+ * splay_seq_last() - Find last node in sequence
+ * @root: pointer to splay root
+ *
+ * Return: pointer to last node. NULL when @root is empty.
+ */
+struct splay_seq_node *splay_seq_last(struct splay_seq_root *root)
+{
+	return splay_seq_end(root, SPLAY_DIR_RIGHT);
+}
+
+/**
+ * splay_seq_next() - Find next node in sequence
+ * @node: starting splay node for search
+ * @root: pointer to splay root
+ *
+ * Return: pointer to next node. NULL when @node is the last node.
+ */
+struct splay_seq_node *splay_seq_next(struct splay_seq_node *node,
+				      struct splay_seq_root *root)
+{
+	return splay_seq_step(node, SPLAY_DIR_RIGHT, root);
+}
+
+/**
+ * splay_seq_prev() - Find previous node in sequence
+ * @node: starting splay node for search
+ * @root: pointer to splay root
+ *
+ * Return: pointer to previous node. NULL when @node is the first node.
+ */
+struct splay_seq_node *splay_seq_prev(struct splay_seq_node *node,
+				      struct splay_seq_root *root)
+{
+	return splay_seq_step(node, SPLAY_DIR_LEFT, root);
+}
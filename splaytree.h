@@ -13,6 +13,9 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #if defined(__GNUC__)
 #define SPLAYTREE_TYPEOF_USE 1
@@ -22,6 +25,69 @@ extern "C" {
 #define __inline__ __inline
 #endif
 
+#if defined(SPLAYTREE_USDT)
+#include <sys/sdt.h>
+#endif
+
+/**
+ * enum splay_trace_event - trace points on the splay tree hot paths
+ * @SPLAY_TRACE_SPLAYING_ENTRY: splay_splaying started for node
+ * @SPLAY_TRACE_SPLAYING_EXIT: node reached root, depth and rotations are set
+ * @SPLAY_TRACE_ERASE_ENTRY: splay_erase_node started for node
+ * @SPLAY_TRACE_ERASE_EXIT: node removed, depth is length of successor search
+ * @SPLAY_TRACE_INSERT_ENTRY: splay_insert started for node
+ * @SPLAY_TRACE_INSERT_EXIT: splay_insert finished for node
+ */
+enum splay_trace_event {
+	SPLAY_TRACE_SPLAYING_ENTRY,
+	SPLAY_TRACE_SPLAYING_EXIT,
+	SPLAY_TRACE_ERASE_ENTRY,
+	SPLAY_TRACE_ERASE_EXIT,
+	SPLAY_TRACE_INSERT_ENTRY,
+	SPLAY_TRACE_INSERT_EXIT
+};
+
+struct splay_node;
+
+/**
+ * SPLAYTREE_PROBE() - Static trace point
+ * @name: name of the USDT probe in the provider "splaytree"
+ * @event: enum splay_trace_event for the trace hook
+ * @node: pointer to the splay node of the operation
+ * @depth: depth of the operation
+ * @rotations: number of rotations of the operation
+ *
+ * With SPLAYTREE_USDT, a USDT probe (sys/sdt.h) is placed which can be
+ * attached by tools like bpftrace or perf. It is only a nop instruction when
+ * no tracer is attached. With SPLAYTREE_TRACE, the function registered via
+ * splay_trace_set_hook is called. Nothing is generated otherwise.
+ */
+#if defined(SPLAYTREE_USDT)
+#define SPLAYTREE_PROBE(name, event, node, depth, rotations) \
+	DTRACE_PROBE3(splaytree, name, node, depth, rotations)
+#elif defined(SPLAYTREE_TRACE)
+typedef void (*splay_trace_hook_t)(enum splay_trace_event event,
+				   const struct splay_node *node,
+				   size_t depth, size_t rotations);
+
+extern splay_trace_hook_t splay_trace_hook;
+
+void splay_trace_set_hook(splay_trace_hook_t hook);
+
+#define SPLAYTREE_PROBE(name, event, node, depth, rotations) \
+	do { \
+		if (splay_trace_hook) \
+			splay_trace_hook(event, node, depth, rotations); \
+	} while (0)
+#else
+#define SPLAYTREE_PROBE(name, event, node, depth, rotations) \
+	do { \
+		(void)(node); \
+		(void)(depth); \
+		(void)(rotations); \
+	} while (0)
+#endif
+
 /**
  * container_of() - Calculate address of object that contains address ptr
  * @ptr: pointer to member variable
@@ -65,22 +131,85 @@ struct splay_node {
 	struct splay_node *right;
 };
 
+#ifdef SPLAYTREE_STATS
+/**
+ * SPLAY_STATS_DEPTH_BUCKETS - number of buckets in the depth histogram
+ *
+ * Bucket 0 counts splayings of the root node. Bucket b counts splayings of
+ * nodes with a depth in the range [2^(b-1), 2^b - 1].
+ */
+#define SPLAY_STATS_DEPTH_BUCKETS	(sizeof(size_t) * 8 + 1)
+
+/**
+ * struct splay_stats - operation statistics of a tree
+ * @splayings: number of splay_splaying calls
+ * @zig: number of zig steps (single rotation below the root)
+ * @zigzig: number of zig-zig steps
+ * @zigzag: number of zig-zag steps
+ * @path_length: sum of the depths of all splayed nodes
+ * @erase_leaf: number of erased nodes without children
+ * @erase_one_child: number of erased nodes with one child
+ * @erase_two_children: number of erased nodes with two children
+ * @depth_hist: histogram of the depths of all splayed nodes
+ *
+ * Only available when splaytree.c and all users of struct splay_root or
+ * struct splay_dir_root are compiled with SPLAYTREE_STATS defined.
+ */
+struct splay_stats {
+	uint64_t splayings;
+	uint64_t zig;
+	uint64_t zigzig;
+	uint64_t zigzag;
+	uint64_t path_length;
+	uint64_t erase_leaf;
+	uint64_t erase_one_child;
+	uint64_t erase_two_children;
+	uint64_t depth_hist[SPLAY_STATS_DEPTH_BUCKETS];
+};
+
+/**
+ * struct splay_iter_stats - per thread statistics of tree iterations
+ * @calls: number of splay_next and splay_prev calls
+ * @hops: number of links followed by splay_next and splay_prev
+ *
+ * The iteration functions don't have access to the root of the tree. These
+ * statistics are therefore collected for all trees together. Each thread has
+ * its own counters (thread-local storage) so that concurrent read-only
+ * iterations stay free of data races. Compilers without support for
+ * thread-local storage fall back to a single process wide copy which must
+ * then only be used by one thread.
+ */
+struct splay_iter_stats {
+	uint64_t calls;
+	uint64_t hops;
+};
+#endif
+
 /**
  * struct splay_root - root of an splay-tree
  * @node: pointer to the root node in the tree
+ * @stats: operation statistics (only with SPLAYTREE_STATS)
  *
  * For an empty tree, node points to NULL.
  */
 struct splay_root {
 	struct splay_node *node;
+#ifdef SPLAYTREE_STATS
+	struct splay_stats stats;
+#endif
 };
 
 /**
  * DEFINE_SPLAYROOT - define tree root and initialize it
  * @root: name of the new object
  */
+#ifdef SPLAYTREE_STATS
+#define DEFINE_SPLAYROOT(root) \
+	struct splay_root root = { NULL, { 0, 0, 0, 0, 0, 0, 0, 0, { 0 } } }
+#else
 #define DEFINE_SPLAYROOT(root) \
 	struct splay_root root = { NULL }
+#endif
 
 /**
  * INIT_SPLAY_ROOT() - Initialize empty tree
@@ -89,8 +218,62 @@ struct splay_root {
 static __inline__ void INIT_SPLAY_ROOT(struct splay_root *root)
 {
 	root->node = NULL;
+#ifdef SPLAYTREE_STATS
+	memset(&root->stats, 0, sizeof(root->stats));
+#endif
+}
+
+#ifdef SPLAYTREE_STATS
+/**
+ * splay_stats_snapshot() - Copy current operation statistics of a tree
+ * @root: pointer to splay root
+ * @stats: pointer to the copy of the statistics
+ */
+static __inline__ void splay_stats_snapshot(const struct splay_root *root,
+					    struct splay_stats *stats)
+{
+	*stats = root->stats;
+}
+
+/**
+ * splay_stats_reset() - Reset operation statistics of a tree
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_stats_reset(struct splay_root *root)
+{
+	memset(&root->stats, 0, sizeof(root->stats));
 }
 
+/**
+ * splay_stats_merge() - Add operation statistics of other tree
+ * @root: pointer to splay root which receives the sum of the statistics
+ * @from: pointer to splay root whose statistics are added to @root
+ *
+ * Used for temporary roots of subtrees which are joined into @root again.
+ * The statistics of @from are not modified.
+ */
+static __inline__ void splay_stats_merge(struct splay_root *root,
+					 const struct splay_root *from)
+{
+	size_t i;
+
+	root->stats.splayings += from->stats.splayings;
+	root->stats.zig += from->stats.zig;
+	root->stats.zigzig += from->stats.zigzig;
+	root->stats.zigzag += from->stats.zigzag;
+	root->stats.path_length += from->stats.path_length;
+	root->stats.erase_leaf += from->stats.erase_leaf;
+	root->stats.erase_one_child += from->stats.erase_one_child;
+	root->stats.erase_two_children += from->stats.erase_two_children;
+
+	for (i = 0; i < SPLAY_STATS_DEPTH_BUCKETS; i++)
+		root->stats.depth_hist[i] += from->stats.depth_hist[i];
+}
+
+void splay_iter_stats_snapshot(struct splay_iter_stats *stats);
+void splay_iter_stats_reset(void);
+#endif
+
 /**
  * splay_empty() - Check if tree has no nodes attached
  * @root: pointer to the root of the tree
@@ -141,8 +324,10 @@ static __inline__ void splay_insert(struct splay_node *node,
 				    struct splay_node **splay_link,
 				    struct splay_root *root)
 {
+	SPLAYTREE_PROBE(insert_entry, SPLAY_TRACE_INSERT_ENTRY, node, 0, 0);
 	splay_link_node(node, parent, splay_link);
 	splay_splaying(node, root);
+	SPLAYTREE_PROBE(insert_exit, SPLAY_TRACE_INSERT_EXIT, node, 0, 0);
 }
 
 struct splay_node *splay_erase_node(struct splay_node *node,
@@ -168,6 +353,1496 @@ struct splay_node *splay_last(const struct splay_root *root);
 struct splay_node *splay_next(struct splay_node *node);
 struct splay_node *splay_prev(struct splay_node *node);
 
+struct splay_node *splay_lower_bound(struct splay_root *root, const void *key,
+				     int (*cmp)(const void *key,
+						const struct splay_node *node));
+struct splay_node *splay_upper_bound(struct splay_root *root, const void *key,
+				     int (*cmp)(const void *key,
+						const struct splay_node *node));
+size_t splay_equal_range(struct splay_root *root, const void *key,
+			 int (*cmp)(const void *key,
+				    const struct splay_node *node),
+			 struct splay_node **first, struct splay_node **end);
+size_t splay_count(struct splay_root *root, const void *key,
+		   int (*cmp)(const void *key, const struct splay_node *node));
+
+struct splay_node *splay_split(struct splay_root *root, const void *key,
+			       int (*cmp)(const void *key,
+					  const struct splay_node *node),
+			       struct splay_root *right);
+void splay_join(struct splay_root *root, struct splay_node *middle,
+		struct splay_root *right);
+
+/**
+ * enum splay_set_op - set operation between two trees
+ * @SPLAY_SET_UNION: nodes which are in at least one of the trees
+ * @SPLAY_SET_INTERSECTION: nodes of the first tree which are also in the
+ *  second tree
+ * @SPLAY_SET_DIFFERENCE: nodes of the first tree which are not in the second
+ *  tree
+ */
+enum splay_set_op {
+	SPLAY_SET_UNION,
+	SPLAY_SET_INTERSECTION,
+	SPLAY_SET_DIFFERENCE
+};
+
+void splay_set_operation(struct splay_root *root, struct splay_root *other,
+			 enum splay_set_op op,
+			 int (*cmp)(const void *key,
+				    const struct splay_node *node));
+
+/**
+ * splay_union() - Move all nodes of other tree with new keys to tree
+ * @root: pointer to splay root of the first tree, receives the result
+ * @other: pointer to splay root of the second tree, receives the remaining
+ *  nodes
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ *
+ * See splay_set_operation.
+ */
+static __inline__ void
+splay_union(struct splay_root *root, struct splay_root *other,
+	    int (*cmp)(const void *key, const struct splay_node *node))
+{
+	splay_set_operation(root, other, SPLAY_SET_UNION, cmp);
+}
+
+/**
+ * splay_intersection() - Keep only nodes whose key is also in other tree
+ * @root: pointer to splay root of the first tree, receives the result
+ * @other: pointer to splay root of the second tree, receives the remaining
+ *  nodes
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ *
+ * See splay_set_operation.
+ */
+static __inline__ void
+splay_intersection(struct splay_root *root, struct splay_root *other,
+		   int (*cmp)(const void *key, const struct splay_node *node))
+{
+	splay_set_operation(root, other, SPLAY_SET_INTERSECTION, cmp);
+}
+
+/**
+ * splay_difference() - Remove all nodes whose key is also in other tree
+ * @root: pointer to splay root of the first tree, receives the result
+ * @other: pointer to splay root of the second tree, receives the remaining
+ *  nodes
+ * @cmp: comparison function between a node of @other (passed as key) and a
+ *  node of @root
+ *
+ * See splay_set_operation.
+ */
+static __inline__ void
+splay_difference(struct splay_root *root, struct splay_root *other,
+		 int (*cmp)(const void *key, const struct splay_node *node))
+{
+	splay_set_operation(root, other, SPLAY_SET_DIFFERENCE, cmp);
+}
+
+size_t splay_rebalance(struct splay_root *root);
+size_t splay_depth(const struct splay_node *node);
+
+/**
+ * struct splay_balance - policy to rebalance tree on too deep access paths
+ * @count: number of nodes in the tree
+ * @factor: factor c of the maximum accepted depth c * log2(@count)
+ * @rebalances: number of rebalances triggered by this policy
+ *
+ * Nodes which were only linked (splay_link_node) without splaying or sorted
+ * insertions can degenerate the tree to a list. A single access then needs
+ * O(n) time. The policy is informed about the depth of each access path via
+ * splay_balance_check and rebuilds the tree with splay_rebalance when the
+ * depth is larger than expected. The user must keep @count up-to-date with
+ * splay_balance_inc and splay_balance_dec.
+ */
+struct splay_balance {
+	size_t count;
+	unsigned int factor;
+	size_t rebalances;
+};
+
+/**
+ * INIT_SPLAY_BALANCE() - Initialize rebalance policy for empty tree
+ * @balance: pointer to rebalance policy
+ * @factor: factor c of the maximum accepted depth c * log2(n)
+ */
+static __inline__ void INIT_SPLAY_BALANCE(struct splay_balance *balance,
+					  unsigned int factor)
+{
+	balance->count = 0;
+	balance->factor = factor;
+	balance->rebalances = 0;
+}
+
+/**
+ * splay_balance_inc() - Inform rebalance policy about added node
+ * @balance: pointer to rebalance policy
+ */
+static __inline__ void splay_balance_inc(struct splay_balance *balance)
+{
+	balance->count++;
+}
+
+/**
+ * splay_balance_dec() - Inform rebalance policy about removed node
+ * @balance: pointer to rebalance policy
+ */
+static __inline__ void splay_balance_dec(struct splay_balance *balance)
+{
+	balance->count--;
+}
+
+int splay_balance_check(struct splay_balance *balance,
+			struct splay_root *root, size_t depth);
+
+size_t splay_freeze(const struct splay_root *root, void *base, size_t nmemb,
+		    size_t size,
+		    void (*store)(void *elem, struct splay_node *node));
+size_t splay_frozen_first(size_t nmemb);
+size_t splay_frozen_next(size_t index, size_t nmemb);
+size_t splay_frozen_lower_bound(const void *base, size_t nmemb, size_t size,
+				const void *key,
+				int (*compar)(const void *key,
+					      const void *elem));
+void splay_thaw(struct splay_root *root, void *base, size_t nmemb,
+		size_t size, struct splay_node *(*load)(void *elem));
+
+size_t splay_relayout(struct splay_root *root, void *arena, size_t nmemb,
+		      size_t entry_size, size_t node_offset,
+		      void (*relocate)(void *old_entry, void *new_entry,
+				       void *priv),
+		      void *priv);
+
+/**
+ * SPLAY_SERIALIZE_SHAPE - store shape of the tree in serialized data
+ *
+ * The entries are stored in preorder together with two bits per node which
+ * describe which children exist. splay_deserialize will rebuild the exact
+ * same tree. The entries are otherwise stored in-order and splay_deserialize
+ * builds a balanced tree.
+ */
+#define SPLAY_SERIALIZE_SHAPE	0x1
+
+int splay_serialize(const struct splay_root *root, FILE *fp, size_t size,
+		    unsigned int flags,
+		    void (*store)(void *record, struct splay_node *node,
+				  void *priv),
+		    void *priv);
+int splay_deserialize(struct splay_root *root, FILE *fp, size_t size,
+		      struct splay_node *(*load)(const void *record,
+						 void *priv),
+		      void *priv);
+
+/**
+ * struct splay_off_node - position independent node of an splay tree
+ * @parent: self-relative offset to the parent node in the tree
+ * @left: self-relative offset to the left child in the tree
+ * @right: self-relative offset to the right child in the tree
+ *
+ * The links are not stored as absolute pointers but as the distance between
+ * the address of the link and the address of the linked node. An offset of 0
+ * is used instead of a NULL pointer. The tree therefore stays valid when the
+ * memory which contains the root and all entries is mapped at a different
+ * address - for example a shared memory segment or an mmap'ed file.
+ *
+ * The splay_off_* functions are equivalent to the splay_* functions of the
+ * pointer based tree. The helpers splay_off_get and splay_off_set are used to
+ * read and write the links. The tree doesn't do any locking. A process shared
+ * lock (for example a pthread mutex with PTHREAD_PROCESS_SHARED) must be
+ * placed in the same memory region when multiple processes access the tree.
+ */
+struct splay_off_node {
+	ptrdiff_t parent;
+	ptrdiff_t left;
+	ptrdiff_t right;
+};
+
+/**
+ * struct splay_off_root - root of a position independent splay-tree
+ * @node: self-relative offset to the root node in the tree
+ *
+ * The root must be located in the same memory region as all nodes.
+ */
+struct splay_off_root {
+	ptrdiff_t node;
+};
+
+/**
+ * INIT_SPLAY_OFF_ROOT() - Initialize empty position independent tree
+ * @root: pointer to splay root
+ */
+static __inline__ void INIT_SPLAY_OFF_ROOT(struct splay_off_root *root)
+{
+	root->node = 0;
+}
+
+/**
+ * splay_off_empty() - Check if position independent tree has no nodes
+ * @root: pointer to the root of the tree
+ *
+ * Return: 0 - tree is not empty !0 - tree is empty
+ */
+static __inline__ int splay_off_empty(const struct splay_off_root *root)
+{
+	return !root->node;
+}
+
+/**
+ * splay_off_get() - Get node referenced by a self-relative link
+ * @splay_link: pointer to the parent/left/right link or root node link
+ *
+ * Return: pointer to linked node, NULL when nothing is linked
+ */
+static __inline__ struct splay_off_node *
+splay_off_get(const ptrdiff_t *splay_link)
+{
+	if (!*splay_link)
+		return NULL;
+
+	return (struct splay_off_node *)((char *)splay_link + *splay_link);
+}
+
+/**
+ * splay_off_set() - Set self-relative link to a node
+ * @splay_link: pointer to the parent/left/right link or root node link
+ * @node: pointer to node which should be linked, NULL to unlink
+ */
+static __inline__ void splay_off_set(ptrdiff_t *splay_link,
+				     const struct splay_off_node *node)
+{
+	if (!node)
+		*splay_link = 0;
+	else
+		*splay_link = (const char *)node - (char *)splay_link;
+}
+
+/**
+ * splay_off_link_node() - Add new node as new leaf
+ * @node: pointer to the new node
+ * @parent: pointer to the parent node
+ * @splay_link: pointer to the left/right link of @parent
+ *
+ * @node will be initialized as leaf node of @parent. It will be linked to the
+ * tree via the @splay_link. @parent must be NULL and @splay_link has to
+ * point to "node" of splay_off_root when the tree is empty.
+ *
+ * WARNING A call to splay_off_splaying after splay_off_link_node is required
+ * to follow the standard definition of a splay tree. splay_off_insert can be
+ * used as helper to run both steps at the same time.
+ */
+static __inline__ void splay_off_link_node(struct splay_off_node *node,
+					   struct splay_off_node *parent,
+					   ptrdiff_t *splay_link)
+{
+	splay_off_set(&node->parent, parent);
+	node->left = 0;
+	node->right = 0;
+
+	splay_off_set(splay_link, node);
+}
+
+void splay_off_splaying(struct splay_off_node *node,
+			struct splay_off_root *root);
+
+/**
+ * splay_off_insert() - Add new node as new leaf and reorder tree
+ * @node: pointer to the new node
+ * @parent: pointer to the parent node
+ * @splay_link: pointer to the left/right link of @parent
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_off_insert(struct splay_off_node *node,
+					struct splay_off_node *parent,
+					ptrdiff_t *splay_link,
+					struct splay_off_root *root)
+{
+	splay_off_link_node(node, parent, splay_link);
+	splay_off_splaying(node, root);
+}
+
+struct splay_off_node *splay_off_erase_node(struct splay_off_node *node,
+					    struct splay_off_root *root);
+
+/**
+ * splay_off_erase() - Remove splay node from tree and rebalance tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_off_erase(struct splay_off_node *node,
+				       struct splay_off_root *root)
+{
+	struct splay_off_node *parent;
+
+	parent = splay_off_erase_node(node, root);
+	if (parent)
+		splay_off_splaying(parent, root);
+}
+
+struct splay_off_node *splay_off_first(const struct splay_off_root *root);
+struct splay_off_node *splay_off_last(const struct splay_off_root *root);
+struct splay_off_node *splay_off_next(struct splay_off_node *node);
+struct splay_off_node *splay_off_prev(struct splay_off_node *node);
+
+/**
+ * enum splay_dir - index of a child in struct splay_dir_node
+ * @SPLAY_DIR_LEFT: left (smaller/preceding) child
+ * @SPLAY_DIR_RIGHT: right (larger/succeeding) child
+ */
+enum splay_dir {
+	SPLAY_DIR_LEFT = 0,
+	SPLAY_DIR_RIGHT = 1
+};
+
+/**
+ * struct splay_dir_node - node of an splay tree with indexed children
+ * @parent_side: pointer to the parent node in the tree and (in the lowest bit)
+ *  the index of this node in the child array of the parent
+ * @child: pointer to the left (SPLAY_DIR_LEFT) and right (SPLAY_DIR_RIGHT)
+ *  child in the tree
+ *
+ * The splay_dir_* functions are equivalent to the splay_* functions of the
+ * struct splay_node based tree. But the children are stored in an array and
+ * all operations which exist in a left and right (mirrored) variant are
+ * implemented only once with the direction as index. The side of a descent,
+ * rotation or splay step is therefore calculated instead of being selected by
+ * a conditional branch. This avoids branch mispredictions for random keys.
+ *
+ * The direction of a descent can be calculated from the result of a
+ * comparison with splay_dir_from_cmp.
+ *
+ * The side of a node in its parent is stored in the otherwise unused lowest
+ * bit of the (at least 2 byte aligned) parent pointer. Rotations and upward
+ * walks can therefore check the side without loading the parent node. The
+ * parent and the side must only be accessed via splay_dir_parent and
+ * splay_dir_side.
+ */
+struct splay_dir_node {
+	uintptr_t parent_side;
+	struct splay_dir_node *child[2];
+};
+
+/**
+ * struct splay_dir_root - root of a splay-tree with indexed children
+ * @node: pointer to the root node in the tree
+ * @stats: operation statistics (only with SPLAYTREE_STATS)
+ */
+struct splay_dir_root {
+	struct splay_dir_node *node;
+#ifdef SPLAYTREE_STATS
+	struct splay_stats stats;
+#endif
+};
+
+/**
+ * INIT_SPLAY_DIR_ROOT() - Initialize empty tree with indexed children
+ * @root: pointer to splay root
+ */
+static __inline__ void INIT_SPLAY_DIR_ROOT(struct splay_dir_root *root)
+{
+	root->node = NULL;
+#ifdef SPLAYTREE_STATS
+	memset(&root->stats, 0, sizeof(root->stats));
+#endif
+}
+
+#ifdef SPLAYTREE_STATS
+/**
+ * splay_dir_stats_snapshot() - Copy operation statistics of tree with indexed
+ *  children
+ * @root: pointer to splay root
+ * @stats: pointer to the copy of the statistics
+ */
+static __inline__ void
+splay_dir_stats_snapshot(const struct splay_dir_root *root,
+			 struct splay_stats *stats)
+{
+	*stats = root->stats;
+}
+
+/**
+ * splay_dir_stats_reset() - Reset operation statistics of tree with indexed
+ *  children
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_dir_stats_reset(struct splay_dir_root *root)
+{
+	memset(&root->stats, 0, sizeof(root->stats));
+}
+#endif
+
+/**
+ * splay_dir_empty() - Check if tree with indexed children has no nodes
+ * @root: pointer to the root of the tree
+ *
+ * Return: 0 - tree is not empty !0 - tree is empty
+ */
+static __inline__ int splay_dir_empty(const struct splay_dir_root *root)
+{
+	return !root->node;
+}
+
+/**
+ * splay_dir_from_cmp() - Get child index for comparison result
+ * @res: result of the comparison between searched key and node key
+ *
+ * Return: SPLAY_DIR_RIGHT when @res > 0, SPLAY_DIR_LEFT otherwise
+ */
+static __inline__ enum splay_dir splay_dir_from_cmp(int res)
+{
+	return (enum splay_dir)(res > 0);
+}
+
+/**
+ * splay_dir_parent() - Get parent of node
+ * @node: pointer to the node
+ *
+ * Return: pointer to parent node, NULL when @node is the root node
+ */
+static __inline__ struct splay_dir_node *
+splay_dir_parent(const struct splay_dir_node *node)
+{
+	return (struct splay_dir_node *)(node->parent_side & ~(uintptr_t)1);
+}
+
+/**
+ * splay_dir_side() - Get index of node in the child array of its parent
+ * @node: pointer to the node
+ *
+ * Return: SPLAY_DIR_RIGHT when @node is a right child, SPLAY_DIR_LEFT when it
+ *  is a left child or the root node
+ */
+static __inline__ enum splay_dir
+splay_dir_side(const struct splay_dir_node *node)
+{
+	return (enum splay_dir)(node->parent_side & 1);
+}
+
+/**
+ * splay_dir_set_parent() - Set parent of node
+ * @node: pointer to the node
+ * @parent: pointer to the new parent node, NULL for the root node
+ * @dir: index of @node in the child array of @parent
+ */
+static __inline__ void splay_dir_set_parent(struct splay_dir_node *node,
+					    struct splay_dir_node *parent,
+					    unsigned int dir)
+{
+	node->parent_side = (uintptr_t)parent | dir;
+}
+
+/**
+ * splay_dir_link_node() - Add new node as new leaf
+ * @node: pointer to the new node
+ * @parent: pointer to the parent node
+ * @splay_link: pointer to the child link of @parent
+ *
+ * @node will be initialized as leaf node of @parent. It will be linked to the
+ * tree via the @splay_link. @parent must be NULL and @splay_link has to
+ * point to "node" of splay_dir_root when the tree is empty.
+ *
+ * WARNING A call to splay_dir_splaying after splay_dir_link_node is required
+ * to follow the standard definition of a splay tree. splay_dir_insert can be
+ * used as helper to run both steps at the same time.
+ */
+static __inline__ void splay_dir_link_node(struct splay_dir_node *node,
+					   struct splay_dir_node *parent,
+					   struct splay_dir_node **splay_link)
+{
+	unsigned int dir = 0;
+
+	if (parent)
+		dir = splay_link == &parent->child[SPLAY_DIR_RIGHT];
+
+	splay_dir_set_parent(node, parent, dir);
+	node->child[SPLAY_DIR_LEFT] = NULL;
+	node->child[SPLAY_DIR_RIGHT] = NULL;
+
+	*splay_link = node;
+}
+
+void splay_dir_splaying(struct splay_dir_node *node,
+			struct splay_dir_root *root);
+
+/**
+ * splay_dir_insert() - Add new node as new leaf and reorder tree
+ * @node: pointer to the new node
+ * @parent: pointer to the parent node
+ * @splay_link: pointer to the child link of @parent
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_dir_insert(struct splay_dir_node *node,
+					struct splay_dir_node *parent,
+					struct splay_dir_node **splay_link,
+					struct splay_dir_root *root)
+{
+	splay_dir_link_node(node, parent, splay_link);
+	splay_dir_splaying(node, root);
+}
+
+struct splay_dir_node *splay_dir_erase_node(struct splay_dir_node *node,
+					    struct splay_dir_root *root);
+
+/**
+ * splay_dir_erase() - Remove splay node from tree and rebalance tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_dir_erase(struct splay_dir_node *node,
+				       struct splay_dir_root *root)
+{
+	struct splay_dir_node *parent;
+
+	parent = splay_dir_erase_node(node, root);
+	if (parent)
+		splay_dir_splaying(parent, root);
+}
+
+void splay_dir_replace(struct splay_dir_node *old_node,
+		       struct splay_dir_node *new_node,
+		       struct splay_dir_root *root);
+
+struct splay_dir_node *splay_dir_end(const struct splay_dir_root *root,
+				     enum splay_dir dir);
+struct splay_dir_node *splay_dir_step(struct splay_dir_node *node,
+				      enum splay_dir dir);
+
+/**
+ * splay_dir_first() - Find leftmost splay node in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to leftmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_dir_node *
+splay_dir_first(const struct splay_dir_root *root)
+{
+	return splay_dir_end(root, SPLAY_DIR_LEFT);
+}
+
+/**
+ * splay_dir_last() - Find rightmost splay node in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to rightmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_dir_node *
+splay_dir_last(const struct splay_dir_root *root)
+{
+	return splay_dir_end(root, SPLAY_DIR_RIGHT);
+}
+
+/**
+ * splay_dir_next() - Find successor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to successor node. NULL when no successor of @node exist.
+ */
+static __inline__ struct splay_dir_node *
+splay_dir_next(struct splay_dir_node *node)
+{
+	return splay_dir_step(node, SPLAY_DIR_RIGHT);
+}
+
+/**
+ * splay_dir_prev() - Find predecessor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to predecessor node. NULL when no predecessor of @node exist.
+ */
+static __inline__ struct splay_dir_node *
+splay_dir_prev(struct splay_dir_node *node)
+{
+	return splay_dir_step(node, SPLAY_DIR_LEFT);
+}
+
+/**
+ * struct splay_u64_node - node of an splay tree with inline integer key
+ * @dir: tree node with indexed children
+ * @key: key of the node
+ *
+ * The splay_u64_* functions implement a complete ordered map (or multimap)
+ * for unsigned integer keys on top of the splay_dir_* functions. The key is
+ * stored directly after the links and the descents are implemented as inline
+ * functions. A search therefore doesn't need to calculate the address of the
+ * containing entry or to call a comparison function - the key is read from
+ * the same cache line as the child pointers.
+ *
+ * Multiple nodes with the same key can be inserted. A new node is inserted
+ * after all nodes with an equal key.
+ */
+struct splay_u64_node {
+	struct splay_dir_node dir;
+	uint64_t key;
+};
+
+/**
+ * struct splay_u64_root - root of a splay-tree with inline integer keys
+ * @dir: root of the tree with indexed children
+ */
+struct splay_u64_root {
+	struct splay_dir_root dir;
+};
+
+/**
+ * INIT_SPLAY_U64_ROOT() - Initialize empty tree with inline integer keys
+ * @root: pointer to splay root
+ */
+static __inline__ void INIT_SPLAY_U64_ROOT(struct splay_u64_root *root)
+{
+	INIT_SPLAY_DIR_ROOT(&root->dir);
+}
+
+/**
+ * splay_u64_empty() - Check if tree with inline integer keys has no nodes
+ * @root: pointer to the root of the tree
+ *
+ * Return: 0 - tree is not empty !0 - tree is empty
+ */
+static __inline__ int splay_u64_empty(const struct splay_u64_root *root)
+{
+	return splay_dir_empty(&root->dir);
+}
+
+/**
+ * splay_u64_from_dir() - Get integer key node of tree node
+ * @node: pointer to tree node with indexed children, can be NULL
+ *
+ * Return: pointer to node containing @node, NULL when @node is NULL
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_from_dir(struct splay_dir_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return container_of(node, struct splay_u64_node, dir);
+}
+
+/**
+ * splay_u64_insert() - Add new node and reorder tree
+ * @node: pointer to the new node with initialized key
+ * @root: pointer to splay root
+ *
+ * The new @node will be the new root of the tree.
+ */
+static __inline__ void splay_u64_insert(struct splay_u64_node *node,
+					struct splay_u64_root *root)
+{
+	struct splay_dir_node **cur_nodep = &root->dir.node;
+	struct splay_dir_node *parent = NULL;
+	const uint64_t key = node->key;
+	unsigned int dir;
+
+	while (*cur_nodep) {
+		parent = *cur_nodep;
+		dir = key >= splay_u64_from_dir(parent)->key;
+		cur_nodep = &parent->child[dir];
+	}
+
+	splay_dir_insert(&node->dir, parent, cur_nodep, &root->dir);
+}
+
+/**
+ * splay_u64_lower_bound() - Search first node with key not smaller than @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * The found node is splayed to the root of the tree. The last visited node is
+ * splayed instead when no node was found. Otherwise repeated unsuccessful
+ * searches would not adjust the tree.
+ *
+ * Return: first node with key not smaller than @key, NULL if no such node
+ *  exists
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_lower_bound(struct splay_u64_root *root, uint64_t key)
+{
+	struct splay_dir_node *node = root->dir.node;
+	struct splay_u64_node *found = NULL;
+	struct splay_dir_node *last = NULL;
+	struct splay_u64_node *cur;
+	unsigned int dir;
+
+	while (node) {
+		cur = splay_u64_from_dir(node);
+		last = node;
+
+		dir = key > cur->key;
+		found = dir ? found : cur;
+		node = node->child[dir];
+	}
+
+	if (found)
+		splay_dir_splaying(&found->dir, &root->dir);
+	else if (last)
+		splay_dir_splaying(last, &root->dir);
+
+	return found;
+}
+
+/**
+ * splay_u64_find() - Search first node with key @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * See splay_u64_lower_bound for the reordering of the tree.
+ *
+ * Return: first node with key @key, NULL if no such node exists
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_find(struct splay_u64_root *root, uint64_t key)
+{
+	struct splay_u64_node *node;
+
+	node = splay_u64_lower_bound(root, key);
+	if (!node || node->key != key)
+		return NULL;
+
+	return node;
+}
+
+/**
+ * splay_u64_erase() - Remove node from tree and rebalance tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_u64_erase(struct splay_u64_node *node,
+				       struct splay_u64_root *root)
+{
+	splay_dir_erase(&node->dir, &root->dir);
+}
+
+/**
+ * splay_u64_first() - Find node with smallest key in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to leftmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_first(const struct splay_u64_root *root)
+{
+	return splay_u64_from_dir(splay_dir_first(&root->dir));
+}
+
+/**
+ * splay_u64_last() - Find node with largest key in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to rightmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_last(const struct splay_u64_root *root)
+{
+	return splay_u64_from_dir(splay_dir_last(&root->dir));
+}
+
+/**
+ * splay_u64_next() - Find successor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to successor node. NULL when no successor of @node exist.
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_next(struct splay_u64_node *node)
+{
+	return splay_u64_from_dir(splay_dir_next(&node->dir));
+}
+
+/**
+ * splay_u64_prev() - Find predecessor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to predecessor node. NULL when no predecessor of @node exist.
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_prev(struct splay_u64_node *node)
+{
+	return splay_u64_from_dir(splay_dir_prev(&node->dir));
+}
+
+/**
+ * splay_u64_upper_bound() - Search first node with key larger than @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * See splay_u64_lower_bound for the reordering of the tree.
+ *
+ * Return: first node with key larger than @key, NULL if no such node exists
+ */
+static __inline__ struct splay_u64_node *
+splay_u64_upper_bound(struct splay_u64_root *root, uint64_t key)
+{
+	struct splay_dir_node *node = root->dir.node;
+	struct splay_u64_node *found = NULL;
+	struct splay_dir_node *last = NULL;
+	struct splay_u64_node *cur;
+	unsigned int dir;
+
+	while (node) {
+		cur = splay_u64_from_dir(node);
+		last = node;
+
+		dir = key >= cur->key;
+		found = dir ? found : cur;
+		node = node->child[dir];
+	}
+
+	if (found)
+		splay_dir_splaying(&found->dir, &root->dir);
+	else if (last)
+		splay_dir_splaying(last, &root->dir);
+
+	return found;
+}
+
+/**
+ * splay_u64_equal_range() - Search all nodes with key @key
+ * @root: pointer to splay root
+ * @key: key to search
+ * @first: pointer to store the first node with key @key, NULL when no such
+ *  node exists
+ * @end: pointer to store the first node with key larger than @key, NULL when
+ *  no such node exists
+ *
+ * See splay_equal_range.
+ *
+ * Return: number of nodes with key @key
+ */
+static __inline__ size_t splay_u64_equal_range(struct splay_u64_root *root,
+					       uint64_t key,
+					       struct splay_u64_node **first,
+					       struct splay_u64_node **end)
+{
+	struct splay_u64_node *upper;
+	struct splay_u64_node *lower;
+	struct splay_u64_node *node;
+	size_t count = 0;
+
+	upper = splay_u64_upper_bound(root, key);
+	lower = splay_u64_lower_bound(root, key);
+
+	for (node = lower; node != upper; node = splay_u64_next(node))
+		count++;
+
+	if (!count)
+		lower = NULL;
+
+	if (first)
+		*first = lower;
+	if (end)
+		*end = upper;
+
+	return count;
+}
+
+/**
+ * splay_u64_count() - Count nodes with key @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * Return: number of nodes with key @key
+ */
+static __inline__ size_t splay_u64_count(struct splay_u64_root *root,
+					 uint64_t key)
+{
+	return splay_u64_equal_range(root, key, NULL, NULL);
+}
+
+/**
+ * struct splay_u64_multi_node - entry of an integer multimap with collapsed
+ *  duplicates
+ * @tree: node in the tree with inline integer keys
+ * @dup_next: next entry with the same key
+ * @dup_prev: previous entry with the same key
+ * @count: number of entries with the same key, only valid in the head entry
+ * @head: true when @tree is linked in the tree, false when the entry is only
+ *  linked in the duplicate list
+ *
+ * The splay_u64_multi_* functions store only one entry per distinct key in a
+ * splay_u64_root. All other entries with the same key are kept in a circular
+ * list (in insertion order) starting at this head entry. Large numbers of
+ * equal keys therefore neither increase the depth of the tree nor have to be
+ * rotated during splaying.
+ *
+ * The splay_u64_* iteration functions can be used to walk over the distinct
+ * keys and splay_u64_multi_dup_next to walk over the entries of a key. The
+ * key has to be set in @tree before the entry is inserted.
+ */
+struct splay_u64_multi_node {
+	struct splay_u64_node tree;
+	struct splay_u64_multi_node *dup_next;
+	struct splay_u64_multi_node *dup_prev;
+	size_t count;
+	bool head;
+};
+
+/**
+ * splay_u64_multi_from_u64() - Get multimap entry of integer key node
+ * @node: pointer to node with inline integer key, can be NULL
+ *
+ * Return: pointer to entry containing @node, NULL when @node is NULL
+ */
+static __inline__ struct splay_u64_multi_node *
+splay_u64_multi_from_u64(struct splay_u64_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return container_of(node, struct splay_u64_multi_node, tree);
+}
+
+/**
+ * splay_u64_multi_find() - Search first entry with key @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * See splay_u64_lower_bound for the reordering of the tree.
+ *
+ * Return: head entry of @key, NULL if no such entry exists
+ */
+static __inline__ struct splay_u64_multi_node *
+splay_u64_multi_find(struct splay_u64_root *root, uint64_t key)
+{
+	return splay_u64_multi_from_u64(splay_u64_find(root, key));
+}
+
+/**
+ * splay_u64_multi_insert() - Add new entry to multimap
+ * @node: pointer to the new entry with initialized key
+ * @root: pointer to splay root
+ *
+ * The entry becomes the head of a new key in the tree when its key was not
+ * yet stored. Otherwise, it is appended to the duplicate list of the key. The
+ * node with the key of @node is the root of the tree afterwards.
+ */
+static __inline__ void splay_u64_multi_insert(struct splay_u64_multi_node *node,
+					      struct splay_u64_root *root)
+{
+	struct splay_u64_multi_node *head;
+
+	head = splay_u64_multi_find(root, node->tree.key);
+	if (!head) {
+		node->dup_next = node;
+		node->dup_prev = node;
+		node->count = 1;
+		node->head = true;
+		splay_u64_insert(&node->tree, root);
+		return;
+	}
+
+	node->dup_next = head;
+	node->dup_prev = head->dup_prev;
+	node->head = false;
+	head->dup_prev->dup_next = node;
+	head->dup_prev = node;
+	head->count++;
+}
+
+/**
+ * splay_u64_multi_erase() - Remove entry from multimap
+ * @node: pointer to the entry
+ * @root: pointer to splay root
+ *
+ * A head entry is replaced in the tree by the next entry with the same key,
+ * which takes over the entry count. The tree is only modified when the last
+ * entry of a key is removed. The head of another entry is searched (and
+ * splayed) to update the entry count of the key.
+ */
+static __inline__ void splay_u64_multi_erase(struct splay_u64_multi_node *node,
+					     struct splay_u64_root *root)
+{
+	struct splay_u64_multi_node *next = node->dup_next;
+	struct splay_u64_multi_node *head;
+
+	if (next == node) {
+		splay_u64_erase(&node->tree, root);
+		return;
+	}
+
+	node->dup_prev->dup_next = next;
+	next->dup_prev = node->dup_prev;
+
+	if (node->head) {
+		splay_dir_replace(&node->tree.dir, &next->tree.dir, &root->dir);
+		next->count = node->count - 1;
+		next->head = true;
+		return;
+	}
+
+	head = splay_u64_multi_find(root, node->tree.key);
+	head->count--;
+}
+
+/**
+ * splay_u64_multi_dup_next() - Find next entry with the same key
+ * @node: starting entry for search
+ *
+ * Return: pointer to next entry with the same key. NULL when @node is the
+ *  last entry of its key.
+ */
+static __inline__ struct splay_u64_multi_node *
+splay_u64_multi_dup_next(struct splay_u64_multi_node *node)
+{
+	if (node->dup_next->head)
+		return NULL;
+
+	return node->dup_next;
+}
+
+/**
+ * splay_u64_multi_count() - Count entries with key @key
+ * @root: pointer to splay root
+ * @key: key to search
+ *
+ * The count is stored in the head entry. The duplicate list is therefore not
+ * walked and the cost is the one of splay_u64_multi_find.
+ *
+ * Return: number of entries with key @key
+ */
+static __inline__ size_t splay_u64_multi_count(struct splay_u64_root *root,
+					       uint64_t key)
+{
+	struct splay_u64_multi_node *node;
+
+	node = splay_u64_multi_find(root, key);
+	if (!node)
+		return 0;
+
+	return node->count;
+}
+
+/**
+ * struct splay_str_node - node of an splay tree with cached string key prefix
+ * @dir: tree node with indexed children
+ * @prefix: first (up to) 8 bytes of @key packed in big-endian order and
+ *  padded with zeros
+ * @key: pointer to the key bytes - stored outside of the node
+ * @len: number of bytes in @key
+ *
+ * The splay_str_* functions implement an ordered map (or multimap) for byte
+ * string keys on top of the splay_dir_* functions. The keys are ordered like
+ * memcmp over the common length - a shorter key is sorted before a longer key
+ * with the same beginning.
+ *
+ * The integer comparison of the cached prefixes has the same result as the
+ * comparison of the first 8 bytes of the keys. Most decisions in a descent
+ * are therefore made with the data in the node itself. The key bytes are only
+ * compared (via memcmp) when the prefixes are equal.
+ *
+ * The node must be initialized with splay_str_node_init before it is
+ * inserted. The key bytes must not be modified while the node is in a tree.
+ * Multiple nodes with the same key can be inserted. A new node is inserted
+ * after all nodes with an equal key.
+ */
+struct splay_str_node {
+	struct splay_dir_node dir;
+	uint64_t prefix;
+	const void *key;
+	size_t len;
+};
+
+/**
+ * struct splay_str_root - root of a splay-tree with string keys
+ * @dir: root of the tree with indexed children
+ */
+struct splay_str_root {
+	struct splay_dir_root dir;
+};
+
+/**
+ * INIT_SPLAY_STR_ROOT() - Initialize empty tree with string keys
+ * @root: pointer to splay root
+ */
+static __inline__ void INIT_SPLAY_STR_ROOT(struct splay_str_root *root)
+{
+	INIT_SPLAY_DIR_ROOT(&root->dir);
+}
+
+/**
+ * splay_str_empty() - Check if tree with string keys has no nodes
+ * @root: pointer to the root of the tree
+ *
+ * Return: 0 - tree is not empty !0 - tree is empty
+ */
+static __inline__ int splay_str_empty(const struct splay_str_root *root)
+{
+	return splay_dir_empty(&root->dir);
+}
+
+/**
+ * splay_str_from_dir() - Get string key node of tree node
+ * @node: pointer to tree node with indexed children, can be NULL
+ *
+ * Return: pointer to node containing @node, NULL when @node is NULL
+ */
+static __inline__ struct splay_str_node *
+splay_str_from_dir(struct splay_dir_node *node)
+{
+	if (!node)
+		return NULL;
+
+	return container_of(node, struct splay_str_node, dir);
+}
+
+/**
+ * splay_str_prefix() - Pack beginning of key as big-endian integer
+ * @key: pointer to the key bytes
+ * @len: number of bytes in @key
+ *
+ * Return: first (up to) 8 bytes of @key, big-endian and padded with zeros
+ */
+static __inline__ uint64_t splay_str_prefix(const void *key, size_t len)
+{
+	const unsigned char *bytes = (const unsigned char *)key;
+	uint64_t prefix = 0;
+	size_t i;
+
+	for (i = 0; i < sizeof(prefix); i++) {
+		prefix <<= 8;
+		if (i < len)
+			prefix |= bytes[i];
+	}
+
+	return prefix;
+}
+
+/**
+ * splay_str_node_init() - Initialize key of string key node
+ * @node: pointer to the node
+ * @key: pointer to the key bytes
+ * @len: number of bytes in @key
+ */
+static __inline__ void splay_str_node_init(struct splay_str_node *node,
+					   const void *key, size_t len)
+{
+	node->prefix = splay_str_prefix(key, len);
+	node->key = key;
+	node->len = len;
+}
+
+/**
+ * splay_str_cmp() - Compare key with key of node
+ * @prefix: result of splay_str_prefix for @key
+ * @key: pointer to the key bytes
+ * @len: number of bytes in @key
+ * @node: pointer to the node
+ *
+ * Return: <0 when @key is smaller, 0 when it is equal, >0 when it is larger
+ *  than the key of @node
+ */
+static __inline__ int splay_str_cmp(uint64_t prefix, const void *key,
+				    size_t len,
+				    const struct splay_str_node *node)
+{
+	size_t common;
+	int res;
+
+	if (prefix != node->prefix)
+		return prefix < node->prefix ? -1 : 1;
+
+	common = len < node->len ? len : node->len;
+	if (common) {
+		res = memcmp(key, node->key, common);
+		if (res)
+			return res;
+	}
+
+	if (len == node->len)
+		return 0;
+
+	return len < node->len ? -1 : 1;
+}
+
+/**
+ * splay_str_insert() - Add new node and reorder tree
+ * @node: pointer to the new node initialized with splay_str_node_init
+ * @root: pointer to splay root
+ *
+ * The new @node will be the new root of the tree.
+ */
+static __inline__ void splay_str_insert(struct splay_str_node *node,
+					struct splay_str_root *root)
+{
+	struct splay_dir_node **cur_nodep = &root->dir.node;
+	struct splay_dir_node *parent = NULL;
+	int res;
+
+	while (*cur_nodep) {
+		parent = *cur_nodep;
+		res = splay_str_cmp(node->prefix, node->key, node->len,
+				    splay_str_from_dir(parent));
+		cur_nodep = &parent->child[res >= 0];
+	}
+
+	splay_dir_insert(&node->dir, parent, cur_nodep, &root->dir);
+}
+
+/**
+ * splay_str_lower_bound() - Search first node with key not smaller than @key
+ * @root: pointer to splay root
+ * @key: pointer to the key bytes
+ * @len: number of bytes in @key
+ *
+ * The found node is splayed to the root of the tree. The last visited node is
+ * splayed instead when no node was found. Otherwise repeated unsuccessful
+ * searches would not adjust the tree.
+ *
+ * Return: first node with key not smaller than @key, NULL if no such node
+ *  exists
+ */
+static __inline__ struct splay_str_node *
+splay_str_lower_bound(struct splay_str_root *root, const void *key,
+		      size_t len)
+{
+	const uint64_t prefix = splay_str_prefix(key, len);
+	struct splay_dir_node *node = root->dir.node;
+	struct splay_str_node *found = NULL;
+	struct splay_dir_node *last = NULL;
+	struct splay_str_node *cur;
+	unsigned int dir;
+
+	while (node) {
+		cur = splay_str_from_dir(node);
+		last = node;
+
+		dir = splay_str_cmp(prefix, key, len, cur) > 0;
+		found = dir ? found : cur;
+		node = node->child[dir];
+	}
+
+	if (found)
+		splay_dir_splaying(&found->dir, &root->dir);
+	else if (last)
+		splay_dir_splaying(last, &root->dir);
+
+	return found;
+}
+
+/**
+ * splay_str_find() - Search first node with key @key
+ * @root: pointer to splay root
+ * @key: pointer to the key bytes
+ * @len: number of bytes in @key
+ *
+ * See splay_str_lower_bound for the reordering of the tree.
+ *
+ * Return: first node with key @key, NULL if no such node exists
+ */
+static __inline__ struct splay_str_node *
+splay_str_find(struct splay_str_root *root, const void *key, size_t len)
+{
+	struct splay_str_node *node;
+
+	node = splay_str_lower_bound(root, key, len);
+	if (!node || node->len != len)
+		return NULL;
+
+	if (len && memcmp(node->key, key, len) != 0)
+		return NULL;
+
+	return node;
+}
+
+/**
+ * splay_str_erase() - Remove node from tree and rebalance tree
+ * @node: pointer to the node
+ * @root: pointer to splay root
+ */
+static __inline__ void splay_str_erase(struct splay_str_node *node,
+				       struct splay_str_root *root)
+{
+	splay_dir_erase(&node->dir, &root->dir);
+}
+
+/**
+ * splay_str_first() - Find node with smallest key in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to leftmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_str_node *
+splay_str_first(const struct splay_str_root *root)
+{
+	return splay_str_from_dir(splay_dir_first(&root->dir));
+}
+
+/**
+ * splay_str_last() - Find node with largest key in tree
+ * @root: pointer to splay root
+ *
+ * Return: pointer to rightmost node. NULL when @root is empty.
+ */
+static __inline__ struct splay_str_node *
+splay_str_last(const struct splay_str_root *root)
+{
+	return splay_str_from_dir(splay_dir_last(&root->dir));
+}
+
+/**
+ * splay_str_next() - Find successor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to successor node. NULL when no successor of @node exist.
+ */
+static __inline__ struct splay_str_node *
+splay_str_next(struct splay_str_node *node)
+{
+	return splay_str_from_dir(splay_dir_next(&node->dir));
+}
+
+/**
+ * splay_str_prev() - Find predecessor node in tree
+ * @node: starting splay node for search
+ *
+ * Return: pointer to predecessor node. NULL when no predecessor of @node exist.
+ */
+static __inline__ struct splay_str_node *
+splay_str_prev(struct splay_str_node *node)
+{
+	return splay_str_from_dir(splay_dir_prev(&node->dir));
+}
+
+/**
+ * struct splay_seq_node - node of an splay tree ordered by position
+ * @parent: pointer to the parent node in the tree
+ * @child: pointer to the left (SPLAY_DIR_LEFT) and right (SPLAY_DIR_RIGHT)
+ *  child in the tree
+ * @size: number of nodes in the subtree starting at this node
+ * @reversed: !0 when the order of the nodes below this node must still be
+ *  reversed
+ *
+ * The splay_seq_* functions implement a sequence (rope). The nodes are not
+ * ordered by a key but only by their position in the sequence. The position
+ * (index) of a node is calculated from the @size of the subtrees. It
+ * therefore changes automatically when nodes are inserted or removed in front
+ * of it.
+ *
+ * Inserting and removing at an index, splitting at an index, joining two
+ * sequences and moving a slice between sequences are all done with a constant
+ * number of splay operations and therefore need O(log n) amortized time.
+ */
+struct splay_seq_node {
+	struct splay_seq_node *parent;
+	struct splay_seq_node *child[2];
+	size_t size;
+	unsigned int reversed;
+};
+
+/**
+ * struct splay_seq_ops - callbacks for user data attached to the sequence
+ * @push: move the pending (lazy) update of a node to its children. Can be
+ *  NULL
+ * @update: recalculate the aggregated data of a node from its children after
+ *  they were changed. Can be NULL
+ *
+ * A range update is applied to the root of a subtree which contains exactly
+ * the nodes of the range (see splay_seq_apply). The node itself is updated
+ * immediately and the update for its children is only recorded in the node.
+ * Every function which walks through a node first calls @push for it. The
+ * children of the node are therefore up-to-date when they are visited or
+ * rotated. @update is called bottom-up for every node whose children
+ * changed. The child pointers of the node can be used in both callbacks but
+ * the parent pointer must not be accessed.
+ */
+struct splay_seq_ops {
+	void (*push)(struct splay_seq_node *node);
+	void (*update)(struct splay_seq_node *node);
+};
+
+/**
+ * struct splay_seq_root - root of a sequence splay-tree
+ * @node: pointer to the root node in the tree
+ * @ops: callbacks for lazy updates and aggregated data, NULL when not used
+ */
+struct splay_seq_root {
+	struct splay_seq_node *node;
+	const struct splay_seq_ops *ops;
+};
+
+/**
+ * INIT_SPLAY_SEQ_ROOT() - Initialize empty sequence
+ * @root: pointer to splay root
+ */
+static __inline__ void INIT_SPLAY_SEQ_ROOT(struct splay_seq_root *root)
+{
+	root->node = NULL;
+	root->ops = NULL;
+}
+
+/**
+ * INIT_SPLAY_SEQ_ROOT_OPS() - Initialize empty sequence with callbacks
+ * @root: pointer to splay root
+ * @ops: callbacks for lazy updates and aggregated data
+ */
+static __inline__ void
+INIT_SPLAY_SEQ_ROOT_OPS(struct splay_seq_root *root,
+			const struct splay_seq_ops *ops)
+{
+	root->node = NULL;
+	root->ops = ops;
+}
+
+/**
+ * splay_seq_empty() - Check if sequence has no nodes
+ * @root: pointer to the root of the tree
+ *
+ * Return: 0 - tree is not empty !0 - tree is empty
+ */
+static __inline__ int splay_seq_empty(const struct splay_seq_root *root)
+{
+	return !root->node;
+}
+
+/**
+ * splay_seq_size() - Get number of nodes in sequence
+ * @root: pointer to the root of the tree
+ *
+ * Return: number of nodes in the sequence
+ */
+static __inline__ size_t splay_seq_size(const struct splay_seq_root *root)
+{
+	if (!root->node)
+		return 0;
+
+	return root->node->size;
+}
+
+void splay_seq_splaying(struct splay_seq_node *node,
+			struct splay_seq_root *root);
+struct splay_seq_node *splay_seq_at(struct splay_seq_root *root,
+				    size_t index);
+size_t splay_seq_index(struct splay_seq_node *node,
+		       struct splay_seq_root *root);
+int splay_seq_insert_at(struct splay_seq_node *node, size_t index,
+			struct splay_seq_root *root);
+void splay_seq_erase(struct splay_seq_node *node,
+		     struct splay_seq_root *root);
+struct splay_seq_node *splay_seq_erase_at(size_t index,
+					  struct splay_seq_root *root);
+void splay_seq_split(struct splay_seq_root *root, size_t index,
+		     struct splay_seq_root *right);
+void splay_seq_join(struct splay_seq_root *root,
+		    struct splay_seq_root *right);
+void splay_seq_cut(struct splay_seq_root *root, size_t index, size_t count,
+		   struct splay_seq_root *slice);
+int splay_seq_splice(struct splay_seq_root *root, size_t index,
+		     struct splay_seq_root *slice);
+void splay_seq_apply(struct splay_seq_root *root, size_t index, size_t count,
+		     void (*apply)(struct splay_seq_node *node, void *arg),
+		     void *arg);
+void splay_seq_reverse(struct splay_seq_root *root, size_t index,
+		       size_t count);
+
+struct splay_seq_node *splay_seq_first(struct splay_seq_root *root);
+struct splay_seq_node *splay_seq_last(struct splay_seq_root *root);
+struct splay_seq_node *splay_seq_next(struct splay_seq_node *node,
+				      struct splay_seq_root *root);
+struct splay_seq_node *splay_seq_prev(struct splay_seq_node *node,
+				      struct splay_seq_root *root);
+
 /**
  * splay_entry() - Calculate address of entry that contains tree node
  * @node: pointer to tree node
@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaycache.h"
+#include "../splaytree.h"
+#include "common.h"
+
+#define MAX_COUNT 64
+#define MAX_BYTES 1000
+
+struct cacheitem {
+	uint16_t i;
+	uint8_t cached;
+	struct splay_cache_entry cache;
+};
+
+static uint16_t values[256];
+static struct cacheitem items[ARRAY_SIZE(values)];
+static size_t evicted;
+
+static void cacheitem_evict(struct splay_cache *cache,
+			    struct splay_cache_entry *entry, void *priv)
+{
+	struct cacheitem *item;
+
+	assert(cache);
+	assert(priv == &evicted);
+
+	item = splay_entry(entry, struct cacheitem, cache);
+	assert(item->cached);
+	item->cached = 0;
+	evicted++;
+}
+
+static void check_cache(struct splay_cache *cache)
+{
+	struct splay_cache_entry *entry;
+	struct splay_u64_node *node;
+	struct cacheitem *item;
+	size_t count = 0;
+	size_t bytes = 0;
+	size_t j;
+
+	for (entry = cache->mru; entry; entry = entry->lru_next) {
+		item = splay_entry(entry, struct cacheitem, cache);
+		assert(item->cached);
+		if (entry->lru_next)
+			assert(entry->lru_next->lru_prev == entry);
+		else
+			assert(cache->lru == entry);
+
+		count++;
+		bytes += entry->size;
+	}
+	assert(count == cache->count);
+	assert(bytes == cache->bytes);
+
+	count = 0;
+	for (node = splay_u64_first(&cache->root); node;
+	     node = splay_u64_next(node))
+		count++;
+	assert(count == cache->count);
+
+	count = 0;
+	for (j = 0; j < ARRAY_SIZE(items); j++) {
+		if (items[j].cached)
+			count++;
+	}
+	assert(count == cache->count);
+}
+
+int main(void)
+{
+	struct splay_cache_entry *entry;
+	struct splay_cache cache;
+	struct cacheitem *removed;
+	struct cacheitem *item;
+	size_t i, j;
+	size_t size;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(items, 0, sizeof(items));
+		evicted = 0;
+
+		splay_cache_init(&cache, MAX_COUNT, MAX_BYTES, cacheitem_evict,
+				 &evicted);
+		assert(!splay_cache_lookup(&cache, 0));
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[values[j]];
+			item->i = values[j];
+			size = item->i % 32;
+
+			assert(splay_cache_insert(&cache, &item->cache, item->i,
+						  size) == 0);
+			item->cached = 1;
+			assert(cache.mru == &item->cache);
+			assert(cache.count <= MAX_COUNT);
+			assert(cache.bytes <= MAX_BYTES);
+
+			/* duplicate keys are rejected */
+			assert(splay_cache_insert(&cache, &items[0].cache,
+						  item->i, 1) == -1);
+
+			/* hit moves entry to the front of recency list */
+			if (j >= 1) {
+				item = &items[values[j - 1]];
+				entry = splay_cache_lookup(&cache, item->i);
+				assert(entry == (item->cached ? &item->cache :
+								NULL));
+				if (entry)
+					assert(cache.mru == entry);
+			}
+
+			check_cache(&cache);
+		}
+		assert(evicted + cache.count == ARRAY_SIZE(values));
+
+		/* explicit removal doesn't evict */
+		entry = cache.mru;
+		removed = splay_entry(entry, struct cacheitem, cache);
+		splay_cache_remove(&cache, entry);
+		removed->cached = 0;
+		assert(!splay_cache_lookup(&cache, removed->i));
+		check_cache(&cache);
+
+		/* smaller limits evict least recently used entries */
+		entry = cache.mru;
+		splay_cache_set_limits(&cache, 1, 0);
+		assert(cache.count == 1);
+		assert(cache.mru == entry);
+		check_cache(&cache);
+
+		/* oversized entry is kept when it is the newest entry */
+		splay_cache_set_limits(&cache, 0, 10);
+		assert(splay_cache_insert(&cache, &removed->cache, removed->i,
+					  11) == 0);
+		removed->cached = 1;
+		assert(cache.count == 1);
+		assert(cache.bytes == 11);
+		assert(cache.mru == &removed->cache);
+		check_cache(&cache);
+
+		splay_cache_clear(&cache);
+		assert(cache.count == 0);
+		assert(cache.bytes == 0);
+		assert(splay_u64_empty(&cache.root));
+		check_cache(&cache);
+	}
+
+	return 0;
+}
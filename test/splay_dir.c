@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct diritem {
+	uint16_t i;
+	struct splay_dir_node splay;
+};
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static struct diritem items[ARRAY_SIZE(values)];
+
+static void diritem_insert(struct splay_dir_root *root,
+			   struct diritem *new_entry)
+{
+	struct splay_dir_node **cur_nodep = &root->node;
+	struct splay_dir_node *parent = NULL;
+	struct diritem *cur_entry;
+	enum splay_dir dir;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct diritem, splay);
+
+		parent = *cur_nodep;
+		dir = splay_dir_from_cmp(cmpint(&new_entry->i, &cur_entry->i));
+		cur_nodep = &((*cur_nodep)->child[dir]);
+	}
+
+	splay_dir_insert(&new_entry->splay, parent, cur_nodep, root);
+}
+
+static struct diritem *diritem_find(struct splay_dir_root *root, uint16_t x)
+{
+	struct splay_dir_node *cur_node = root->node;
+	struct diritem *cur_entry;
+	int res;
+
+	while (cur_node) {
+		cur_entry = splay_entry(cur_node, struct diritem, splay);
+
+		res = cmpint(&x, &cur_entry->i);
+		if (res == 0)
+			return cur_entry;
+
+		cur_node = cur_node->child[splay_dir_from_cmp(res)];
+	}
+
+	return NULL;
+}
+
+static void check_node_order(struct splay_dir_node *node,
+			     struct splay_dir_node *parent,
+			     uint16_t *pos)
+{
+	struct diritem *item;
+
+	if (!node)
+		return;
+
+	assert(splay_dir_parent(node) == parent);
+	if (parent)
+		assert(parent->child[splay_dir_side(node)] == node);
+	else
+		assert(splay_dir_side(node) == SPLAY_DIR_LEFT);
+
+	check_node_order(node->child[SPLAY_DIR_LEFT], node, pos);
+
+	while (*pos < ARRAY_SIZE(skiplist) && skiplist[*pos])
+		(*pos)++;
+	assert(*pos < ARRAY_SIZE(skiplist));
+
+	item = splay_entry(node, struct diritem, splay);
+	assert(item->i == *pos);
+	(*pos)++;
+
+	check_node_order(node->child[SPLAY_DIR_RIGHT], node, pos);
+}
+
+static void check_root_order(struct splay_dir_root *root)
+{
+	struct splay_dir_node *node;
+	struct diritem *item;
+	uint16_t pos = 0;
+	int last = -1;
+
+	check_node_order(root->node, NULL, &pos);
+	while (pos < ARRAY_SIZE(skiplist) && skiplist[pos])
+		pos++;
+	assert(pos == ARRAY_SIZE(skiplist));
+
+	for (node = splay_dir_first(root); node; node = splay_dir_next(node)) {
+		item = splay_entry(node, struct diritem, splay);
+		assert(last < item->i);
+		last = item->i;
+	}
+
+	last = ARRAY_SIZE(values);
+	for (node = splay_dir_last(root); node; node = splay_dir_prev(node)) {
+		item = splay_entry(node, struct diritem, splay);
+		assert(last > item->i);
+		last = item->i;
+	}
+}
+
+int main(void)
+{
+	struct splay_dir_root root;
+	struct diritem *item;
+	size_t i, j;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_DIR_ROOT(&root);
+		assert(splay_dir_empty(&root));
+		assert(!splay_dir_first(&root));
+		assert(!splay_dir_last(&root));
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[j];
+			item->i = values[j];
+			diritem_insert(&root, item);
+			skiplist[values[j]] = 0;
+
+			assert(root.node == &item->splay);
+			check_root_order(&root);
+		}
+
+		/* lookup moves found entry to the root */
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items) / 2; j++) {
+			item = diritem_find(&root, delete_items[j]);
+			assert(item);
+
+			splay_dir_splaying(&item->splay, &root);
+			assert(root.node == &item->splay);
+		}
+		check_root_order(&root);
+
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = diritem_find(&root, delete_items[j]);
+			assert(item);
+
+			splay_dir_erase(&item->splay, &root);
+			skiplist[item->i] = 1;
+
+			check_root_order(&root);
+		}
+		assert(splay_dir_empty(&root));
+	}
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+#define DUPLICATES 4
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static size_t counts[ARRAY_SIZE(values) / DUPLICATES + 1];
+
+static struct splayitem items[ARRAY_SIZE(values)];
+
+static int cmpnode(const void *key, const struct splay_node *node)
+{
+	const struct splayitem *item;
+
+	item = splay_entry(node, struct splayitem, splay);
+
+	return cmpint(key, &item->i);
+}
+
+static void splayitem_insert(struct splay_root *root,
+			     struct splayitem *new_entry)
+{
+	struct splay_node **cur_nodep = &root->node;
+	struct splay_node *parent = NULL;
+	struct splayitem *cur_entry;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct splayitem, splay);
+
+		parent = *cur_nodep;
+		if (cmpint(&new_entry->i, &cur_entry->i) <= 0)
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+	}
+
+	splay_insert(&new_entry->splay, parent, cur_nodep, root);
+}
+
+static void check_ranges(struct splay_root *root)
+{
+	struct splay_node *first;
+	struct splay_node *end;
+	struct splay_node *node;
+	struct splayitem *item;
+	uint16_t k;
+	size_t count;
+
+	for (k = 0; k < ARRAY_SIZE(counts); k++) {
+		count = splay_equal_range(root, &k, cmpnode, &first, &end);
+		assert(count == counts[k]);
+		assert(splay_count(root, &k, cmpnode) == counts[k]);
+
+		if (!count) {
+			assert(!first);
+		} else {
+			assert(first);
+			assert(root->node == first);
+
+			/* range starts at first equal node */
+			node = splay_prev(first);
+			if (node) {
+				item = splay_entry(node, struct splayitem,
+						   splay);
+				assert(item->i < k);
+			}
+
+			for (node = first; node != end;
+			     node = splay_next(node)) {
+				item = splay_entry(node, struct splayitem,
+						   splay);
+				assert(item->i == k);
+				count--;
+			}
+			assert(count == 0);
+		}
+
+		/* range ends at first larger node */
+		if (end) {
+			item = splay_entry(end, struct splayitem, splay);
+			assert(item->i > k);
+		}
+
+		node = splay_lower_bound(root, &k, cmpnode);
+		if (counts[k])
+			assert(node == first);
+		else
+			assert(node == end);
+
+		assert(splay_upper_bound(root, &k, cmpnode) == end);
+	}
+}
+
+int main(void)
+{
+	struct splay_root root;
+	struct splayitem *item;
+	uint16_t k;
+	size_t i, j;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+
+		INIT_SPLAY_ROOT(&root);
+		k = 0;
+		assert(splay_count(&root, &k, cmpnode) == 0);
+		assert(!splay_lower_bound(&root, &k, cmpnode));
+		assert(!splay_upper_bound(&root, &k, cmpnode));
+
+		for (j = 0; j < ARRAY_SIZE(counts); j++)
+			counts[j] = 0;
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[j];
+			item->i = values[j] / DUPLICATES;
+			splayitem_insert(&root, item);
+			counts[item->i]++;
+		}
+		check_ranges(&root);
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = &items[delete_items[j]];
+
+			splay_erase(&item->splay, &root);
+			counts[item->i]--;
+
+			if (j % 16 == 0)
+				check_ranges(&root);
+		}
+		assert(splay_empty(&root));
+	}
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+struct frozenitem {
+	uint16_t i;
+	struct splayitem *item;
+};
+
+static uint16_t values[256];
+
+static struct splayitem items[ARRAY_SIZE(values)];
+static struct frozenitem frozen[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static void frozen_store(void *elem, struct splay_node *node)
+{
+	struct frozenitem *fitem = (struct frozenitem *)elem;
+
+	fitem->item = splay_entry(node, struct splayitem, splay);
+	fitem->i = fitem->item->i;
+}
+
+static struct splay_node *frozen_load(void *elem)
+{
+	struct frozenitem *fitem = (struct frozenitem *)elem;
+
+	return &fitem->item->splay;
+}
+
+static int frozen_cmp(const void *key, const void *elem)
+{
+	const struct frozenitem *fitem = (const struct frozenitem *)elem;
+
+	return cmpint(key, &fitem->i);
+}
+
+static size_t node_depth(const struct splay_node *node)
+{
+	size_t depth_left;
+	size_t depth_right;
+
+	if (!node)
+		return 0;
+
+	depth_left = node_depth(node->left);
+	depth_right = node_depth(node->right);
+
+	if (depth_left > depth_right)
+		return depth_left + 1;
+	else
+		return depth_right + 1;
+}
+
+int main(void)
+{
+	struct splay_root root;
+	struct splay_node *top;
+	size_t i, j, pos, count;
+	uint16_t key;
+
+	INIT_SPLAY_ROOT(&root);
+	count = splay_freeze(&root, frozen, ARRAY_SIZE(frozen),
+			     sizeof(frozen[0]), frozen_store);
+	assert(count == 0);
+	assert(splay_frozen_first(count) == count);
+	key = 0;
+	assert(splay_frozen_lower_bound(frozen, count, sizeof(frozen[0]), &key,
+					frozen_cmp) == count);
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			if (values[j] % 2 == 0)
+				continue;
+
+			items[j].i = values[j];
+			splayitem_insert_balanced(&root, &items[j]);
+			skiplist[values[j]] = 0;
+		}
+
+		/* array too small */
+		top = root.node;
+		count = splay_freeze(&root, frozen, 3, sizeof(frozen[0]),
+				     frozen_store);
+		assert(count == ARRAY_SIZE(values) / 2);
+		assert(root.node == top);
+
+		count = splay_freeze(&root, frozen, ARRAY_SIZE(frozen),
+				     sizeof(frozen[0]), frozen_store);
+		assert(count == ARRAY_SIZE(values) / 2);
+		assert(root.node == top);
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		/* in-order walk over frozen array */
+		for (pos = splay_frozen_first(count), j = 1;
+		     pos != count;
+		     pos = splay_frozen_next(pos, count), j += 2)
+			assert(frozen[pos].i == j);
+		assert(j == ARRAY_SIZE(values) + 1);
+
+		/* search for existing and missing keys */
+		for (j = 0; j <= ARRAY_SIZE(values); j++) {
+			key = (uint16_t)j;
+			pos = splay_frozen_lower_bound(frozen, count,
+						       sizeof(frozen[0]),
+						       &key, frozen_cmp);
+			if (j >= ARRAY_SIZE(values)) {
+				assert(pos == count);
+				continue;
+			}
+
+			assert(pos < count);
+			assert(frozen[pos].i == (j | 1));
+		}
+
+		/* rebuild balanced tree */
+		splay_thaw(&root, frozen, count, sizeof(frozen[0]),
+			   frozen_load);
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+		assert(node_depth(root.node) == 8);
+	}
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct offitem {
+	uint16_t i;
+	struct splay_off_node splay;
+};
+
+struct offregion {
+	struct splay_off_root root;
+	struct offitem items[256];
+};
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static void offitem_insert(struct splay_off_root *root,
+			   struct offitem *new_entry)
+{
+	struct splay_off_node *parent = NULL;
+	ptrdiff_t *cur_link = &root->node;
+	struct splay_off_node *cur_node;
+	struct offitem *cur_entry;
+
+	while ((cur_node = splay_off_get(cur_link))) {
+		cur_entry = splay_entry(cur_node, struct offitem, splay);
+
+		parent = cur_node;
+		if (cmpint(&new_entry->i, &cur_entry->i) <= 0)
+			cur_link = &cur_node->left;
+		else
+			cur_link = &cur_node->right;
+	}
+
+	splay_off_insert(&new_entry->splay, parent, cur_link, root);
+}
+
+static struct offitem *offitem_find(struct splay_off_root *root, uint16_t x)
+{
+	struct splay_off_node *cur_node = splay_off_get(&root->node);
+	struct offitem *cur_entry;
+	int res;
+
+	while (cur_node) {
+		cur_entry = splay_entry(cur_node, struct offitem, splay);
+
+		res = cmpint(&x, &cur_entry->i);
+		if (res == 0)
+			return cur_entry;
+
+		if (res < 0)
+			cur_node = splay_off_get(&cur_node->left);
+		else
+			cur_node = splay_off_get(&cur_node->right);
+	}
+
+	return NULL;
+}
+
+static void check_node_order(struct splay_off_node *node,
+			     struct splay_off_node *parent,
+			     uint16_t *pos)
+{
+	struct offitem *item;
+
+	if (!node)
+		return;
+
+	assert(splay_off_get(&node->parent) == parent);
+
+	check_node_order(splay_off_get(&node->left), node, pos);
+
+	while (*pos < ARRAY_SIZE(skiplist) && skiplist[*pos])
+		(*pos)++;
+	assert(*pos < ARRAY_SIZE(skiplist));
+
+	item = splay_entry(node, struct offitem, splay);
+	assert(item->i == *pos);
+	(*pos)++;
+
+	check_node_order(splay_off_get(&node->right), node, pos);
+}
+
+static void check_root_order(struct splay_off_root *root)
+{
+	struct splay_off_node *node;
+	struct offitem *item;
+	uint16_t pos = 0;
+	int last = -1;
+
+	check_node_order(splay_off_get(&root->node), NULL, &pos);
+	while (pos < ARRAY_SIZE(skiplist) && skiplist[pos])
+		pos++;
+	assert(pos == ARRAY_SIZE(skiplist));
+
+	for (node = splay_off_first(root); node; node = splay_off_next(node)) {
+		item = splay_entry(node, struct offitem, splay);
+		assert(last < item->i);
+		last = item->i;
+	}
+
+	last = ARRAY_SIZE(values);
+	for (node = splay_off_last(root); node; node = splay_off_prev(node)) {
+		item = splay_entry(node, struct offitem, splay);
+		assert(last > item->i);
+		last = item->i;
+	}
+}
+
+int main(void)
+{
+	struct offregion *region;
+	struct offregion *mapped;
+	struct offitem *item;
+	size_t i, j;
+
+	region = (struct offregion *)malloc(sizeof(*region));
+	assert(region);
+	mapped = (struct offregion *)malloc(sizeof(*mapped));
+	assert(mapped);
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_OFF_ROOT(&region->root);
+		assert(splay_off_empty(&region->root));
+		assert(!splay_off_first(&region->root));
+		assert(!splay_off_last(&region->root));
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &region->items[j];
+			item->i = values[j];
+			offitem_insert(&region->root, item);
+			skiplist[values[j]] = 0;
+
+			assert(splay_off_get(&region->root.node) == &item->splay);
+		}
+		check_root_order(&region->root);
+
+		/* "map" the region at another address */
+		memcpy(mapped, region, sizeof(*mapped));
+		memset(region, 0, sizeof(*region));
+		check_root_order(&mapped->root);
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = offitem_find(&mapped->root, delete_items[j]);
+			assert(item);
+			assert(item >= &mapped->items[0]);
+			assert(item < &mapped->items[ARRAY_SIZE(mapped->items)]);
+
+			splay_off_erase(&item->splay, &mapped->root);
+			skiplist[item->i] = 1;
+
+			check_root_order(&mapped->root);
+		}
+		assert(splay_off_empty(&mapped->root));
+	}
+
+	free(mapped);
+	free(region);
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splayparallel.h"
+#include "../splaytree.h"
+#include "common.h"
+
+struct builditem {
+	uint16_t value;
+	uint16_t seq;
+	struct splay_node splay;
+};
+
+static struct builditem items[1024];
+static struct splay_node *nodes[ARRAY_SIZE(items)];
+
+static int builditem_cmp(const struct splay_node *node1,
+			  const struct splay_node *node2, void *priv)
+{
+	const struct builditem *item1;
+	const struct builditem *item2;
+
+	assert(priv == items);
+
+	item1 = splay_entry(node1, const struct builditem, splay);
+	item2 = splay_entry(node2, const struct builditem, splay);
+
+	if (item1->value < item2->value)
+		return -1;
+	if (item1->value > item2->value)
+		return 1;
+
+	return 0;
+}
+
+static size_t check_node_order(struct splay_node *node,
+			       struct splay_node *parent,
+			       const struct builditem **last, size_t *count)
+{
+	const struct builditem *item;
+	size_t height_left;
+	size_t height_right;
+
+	if (!node)
+		return 0;
+
+	assert(node->parent == parent);
+
+	height_left = check_node_order(node->left, node, last, count);
+
+	item = splay_entry(node, struct builditem, splay);
+	if (*last) {
+		/* equal values keep their input order */
+		assert((*last)->value <= item->value);
+		if ((*last)->value == item->value)
+			assert((*last)->seq < item->seq);
+	}
+	*last = item;
+	(*count)++;
+
+	height_right = check_node_order(node->right, node, last, count);
+
+	if (height_left > height_right)
+		return height_left + 1;
+	else
+		return height_right + 1;
+}
+
+static size_t max_height(size_t count)
+{
+	size_t height = 0;
+
+	while (count) {
+		count >>= 1;
+		height++;
+	}
+
+	return height;
+}
+
+int main(void)
+{
+	static const size_t counts[] = { 0, 1, 2, 3, 7, 64, 100, 1000, 1024 };
+	static const unsigned int threads[] = { 0, 1, 2, 3, 4, 5, 8, 16, 2000 };
+	const struct builditem *last;
+	struct splay_root root;
+	size_t height;
+	size_t count;
+	size_t c, t, i;
+
+	for (c = 0; c < ARRAY_SIZE(counts); c++) {
+		for (t = 0; t < ARRAY_SIZE(threads); t++) {
+			for (i = 0; i < counts[c]; i++) {
+				items[i].value = getnum() / 4;
+				items[i].seq = (uint16_t)i;
+				nodes[i] = &items[i].splay;
+			}
+
+			INIT_SPLAY_ROOT(&root);
+			assert(splay_parallel_build(&root, nodes, counts[c],
+						    builditem_cmp, items,
+						    threads[t]) == 0);
+
+			last = NULL;
+			count = 0;
+			height = check_node_order(root.node, NULL, &last,
+						  &count);
+			assert(count == counts[c]);
+			assert(height == max_height(counts[c]));
+
+			/* nodes array is returned sorted */
+			for (i = 0; i < counts[c]; i++)
+				assert(!i || builditem_cmp(nodes[i - 1],
+							    nodes[i],
+							    items) <= 0);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splayparallel.h"
+#include "../splaytree.h"
+#include "common.h"
+
+struct scanitem {
+	uint16_t value;
+	uint16_t visited;
+	struct splay_node splay;
+};
+
+static uint16_t values[1024];
+static struct scanitem items[ARRAY_SIZE(values)];
+
+static void scanitem_visit(struct splay_node *node, void *priv)
+{
+	struct scanitem *item = splay_entry(node, struct scanitem, splay);
+
+	assert(priv == items);
+
+	/* each item is only visited by a single thread */
+	item->visited++;
+}
+
+static void splay_insert_unbalanced(struct splay_node *new_node,
+				    struct splay_root *root)
+{
+	struct splay_node **cur_node = &root->node;
+	struct splay_node *parent = NULL;
+	struct scanitem *new_item;
+	struct scanitem *cur_item;
+
+	new_item = splay_entry(new_node, struct scanitem, splay);
+
+	while (*cur_node) {
+		parent = *cur_node;
+		cur_item = splay_entry(*cur_node, struct scanitem, splay);
+		if (new_item->value < cur_item->value)
+			cur_node = &((*cur_node)->left);
+		else
+			cur_node = &((*cur_node)->right);
+	}
+
+	splay_link_node(new_node, parent, cur_node);
+}
+
+static void check_visited(struct splay_root *root, size_t count,
+			  unsigned int threads)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		items[i].visited = 0;
+
+	assert(splay_parallel_for_each(root, scanitem_visit, items,
+				       threads) == 0);
+
+	for (i = 0; i < count; i++)
+		assert(items[i].visited == 1);
+}
+
+int main(void)
+{
+	static const size_t counts[] = { 0, 1, 2, 3, 7, 64, 100, 1024 };
+	static const unsigned int threads[] = { 0, 1, 2, 3, 4, 8, 2000 };
+	struct splay_root root;
+	size_t c, t, i;
+
+	for (c = 0; c < ARRAY_SIZE(counts); c++) {
+		for (t = 0; t < ARRAY_SIZE(threads); t++) {
+			random_shuffle_array(values, (uint16_t)counts[c]);
+
+			/* random shape */
+			INIT_SPLAY_ROOT(&root);
+			for (i = 0; i < counts[c]; i++) {
+				items[i].value = values[i];
+				splay_insert_unbalanced(&items[i].splay,
+							&root);
+			}
+			check_visited(&root, counts[c], threads[t]);
+
+			/* degenerated to a list */
+			INIT_SPLAY_ROOT(&root);
+			for (i = 0; i < counts[c]; i++) {
+				items[i].value = (uint16_t)i;
+				splay_insert_unbalanced(&items[i].splay,
+							&root);
+			}
+			check_visited(&root, counts[c], threads[t]);
+		}
+	}
+
+	return 0;
+}
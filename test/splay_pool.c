@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaypool.h"
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static void check_pool(unsigned int flags, size_t slab_size)
+{
+	struct splay_pool pool;
+	struct splay_root root;
+	struct splayitem *item;
+	struct splayitem *reused;
+	size_t i, j;
+
+	splay_pool_init(&pool, sizeof(*item), slab_size, flags);
+	assert(pool.obj_size >= sizeof(*item));
+
+	for (i = 0; i < 16; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = (struct splayitem *)splay_pool_alloc(&pool);
+			assert(item);
+
+			item->i = values[j];
+			splayitem_insert_balanced(&root, item);
+			skiplist[values[j]] = 0;
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+#if defined(__linux__)
+		/* huge page slabs must not straddle two huge page frames */
+		if (flags & SPLAY_POOL_HUGEPAGES)
+			assert((uintptr_t)pool.slabs % (2 * 1024 * 1024) == 0);
+#endif
+
+		/* erase half of the entries and reuse their memory */
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items) / 2; j++) {
+			item = splayitem_find(&root, delete_items[j]);
+			assert(item);
+
+			splay_erase(&item->splay, &root);
+			skiplist[item->i] = 1;
+			splay_pool_free(&pool, item);
+
+			reused = (struct splayitem *)splay_pool_alloc(&pool);
+			assert(reused == item);
+			splay_pool_free(&pool, reused);
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		for (j = 0; j < ARRAY_SIZE(delete_items) / 2; j++) {
+			item = (struct splayitem *)splay_pool_alloc(&pool);
+			assert(item);
+
+			item->i = delete_items[j];
+			splayitem_insert_balanced(&root, item);
+			skiplist[item->i] = 0;
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		/* drop whole tree at once */
+		splay_pool_free_all(&pool);
+		INIT_SPLAY_ROOT(&root);
+		assert(!pool.slabs);
+	}
+}
+
+struct lditem {
+	char c;
+	long double ld;
+};
+
+static void check_alignment(void)
+{
+	size_t align = offsetof(struct lditem, ld);
+	struct splay_pool pool;
+	uintptr_t addr;
+	size_t i;
+
+	/* odd size must still keep long double members aligned */
+	splay_pool_init(&pool, sizeof(long double) + 1, 0, 0);
+
+	for (i = 0; i < 64; i++) {
+		addr = (uintptr_t)splay_pool_alloc(&pool);
+		assert(addr);
+		assert(addr % align == 0);
+	}
+
+	splay_pool_free_all(&pool);
+}
+
+int main(void)
+{
+	check_alignment();
+	check_pool(0, 0);
+	check_pool(0, 1);
+	check_pool(SPLAY_POOL_HUGEPAGES, 0);
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splayrange.h"
+#include "../splaytree.h"
+#include "common.h"
+
+#define SPACE 1024
+#define BASE 4096
+
+/* 1 - unit is free, 0 - unit is allocated */
+static uint8_t freemap[SPACE];
+static uint64_t allocated[SPACE];
+
+static void check_range(struct splay_range *range)
+{
+	struct splay_range_extent *extent;
+	struct splay_node *node;
+	uint64_t free_units = 0;
+	uint64_t last_end = 0;
+	uint64_t last_size = 0;
+	size_t extents = 0;
+	size_t i;
+
+	/* free extents are sorted, coalesced and match the reference */
+	for (node = splay_first(&range->by_addr); node;
+	     node = splay_next(node)) {
+		extent = splay_entry(node, struct splay_range_extent,
+				     addr_node);
+		assert(extent->size > 0);
+		assert(extent->start >= BASE);
+		assert(extent->start + extent->size <= BASE + SPACE);
+		if (extents)
+			assert(last_end < extent->start);
+
+		for (i = 0; i < extent->size; i++)
+			assert(freemap[extent->start - BASE + i]);
+
+		if (extent->start > BASE)
+			assert(!freemap[extent->start - BASE - 1]);
+		if (extent->start + extent->size < BASE + SPACE)
+			assert(!freemap[extent->start + extent->size - BASE]);
+
+		last_end = extent->start + extent->size;
+		free_units += extent->size;
+		extents++;
+	}
+	assert(extents == range->extents);
+	assert(free_units == range->free_units);
+
+	for (i = 0; i < SPACE; i++)
+		free_units -= freemap[i];
+	assert(free_units == 0);
+
+	for (node = splay_first(&range->by_size); node;
+	     node = splay_next(node)) {
+		extent = splay_entry(node, struct splay_range_extent,
+				     size_node);
+		assert(last_size <= extent->size);
+		last_size = extent->size;
+		extents--;
+	}
+	assert(extents == 0);
+}
+
+static void mark(uint64_t start, uint64_t size, uint8_t value)
+{
+	uint64_t i;
+
+	for (i = 0; i < size; i++) {
+		assert(freemap[start - BASE + i] != value);
+		freemap[start - BASE + i] = value;
+	}
+}
+
+static int is_free(uint64_t start, uint64_t size)
+{
+	uint64_t i;
+
+	if (start < BASE || start + size > BASE + SPACE)
+		return 0;
+
+	for (i = 0; i < size; i++) {
+		if (!freemap[start - BASE + i])
+			return 0;
+	}
+
+	return 1;
+}
+
+static uint64_t best_fit(uint64_t size)
+{
+	uint64_t best_start = 0;
+	uint64_t best_size = UINT64_MAX;
+	uint64_t start;
+	uint64_t len;
+	size_t i = 0;
+
+	while (i < SPACE) {
+		if (!freemap[i]) {
+			i++;
+			continue;
+		}
+
+		start = i;
+		while (i < SPACE && freemap[i])
+			i++;
+		len = i - start;
+
+		if (len >= size && len < best_size) {
+			best_size = len;
+			best_start = start + BASE;
+		}
+	}
+
+	return best_start;
+}
+
+int main(void)
+{
+	struct splay_range_span spans[4];
+	struct splay_range range;
+	uint64_t starts[8];
+	uint64_t start;
+	uint64_t size;
+	size_t allocs;
+	size_t i, j;
+	uint16_t op;
+
+	for (i = 0; i < 64; i++) {
+		splay_range_init(&range);
+		memset(freemap, 0, sizeof(freemap));
+		allocs = 0;
+
+		/* add space in two parts which get merged */
+		assert(splay_range_free(&range, BASE + SPACE / 2,
+					SPACE / 2) == 0);
+		assert(splay_range_free(&range, BASE, SPACE / 2) == 0);
+		mark(BASE, SPACE, 1);
+		assert(range.extents == 1);
+		check_range(&range);
+
+		/* overlapping frees are rejected */
+		assert(splay_range_free(&range, BASE + 10, 1) == -1);
+		assert(splay_range_free(&range, 0, BASE + 1) == -1);
+		assert(splay_range_free(&range, 0, 0) == -1);
+
+		for (j = 0; j < 2048; j++) {
+			op = get_unsigned16();
+			size = op % 16 + 1;
+
+			switch (op % 5) {
+			case 0:
+			case 1:
+				start = best_fit(size);
+				if (splay_range_alloc(&range, size,
+						      &starts[0]) < 0) {
+					assert(!start);
+					break;
+				}
+				assert(starts[0] == start);
+				mark(start, size, 0);
+				allocated[allocs++] = start | (size << 32);
+				break;
+			case 2:
+				start = BASE + get_unsigned16() % SPACE;
+				if (splay_range_reserve(&range, start,
+							size) < 0) {
+					assert(!is_free(start, size));
+					break;
+				}
+				mark(start, size, 0);
+				allocated[allocs++] = start | (size << 32);
+				break;
+			default:
+				if (!allocs)
+					break;
+
+				op = get_unsigned16() % allocs;
+				start = allocated[op] & 0xffffffff;
+				size = allocated[op] >> 32;
+				allocated[op] = allocated[--allocs];
+
+				assert(splay_range_free(&range, start,
+							size) == 0);
+				mark(start, size, 1);
+
+				/* double free is rejected */
+				assert(splay_range_free(&range, start,
+							size) == -1);
+				break;
+			}
+			assert(allocs < ARRAY_SIZE(allocated));
+
+			check_range(&range);
+		}
+
+		/* bulk operations */
+		while (allocs) {
+			start = allocated[--allocs] & 0xffffffff;
+			size = allocated[allocs] >> 32;
+			assert(splay_range_free(&range, start, size) == 0);
+			mark(start, size, 1);
+		}
+		assert(range.extents == 1);
+		assert(range.free_units == SPACE);
+
+		assert(splay_range_alloc_bulk(&range, 100, starts, 8) == 8);
+		for (j = 0; j < 8; j++) {
+			assert(starts[j] == BASE + 100 * j);
+			mark(starts[j], 100, 0);
+		}
+		assert(splay_range_alloc_bulk(&range, 100, starts, 8) == 2);
+		mark(starts[0], 100, 0);
+		mark(starts[1], 100, 0);
+		check_range(&range);
+
+		for (j = 0; j < 4; j++) {
+			spans[j].start = BASE + 200 * j;
+			spans[j].size = 100;
+		}
+		assert(splay_range_free_bulk(&range, spans, 4) == 4);
+		for (j = 0; j < 4; j++)
+			mark(spans[j].start, spans[j].size, 1);
+		check_range(&range);
+
+		spans[2].size = 101;
+		assert(splay_range_reserve_bulk(&range, spans, 4) == 2);
+		mark(spans[0].start, spans[0].size, 0);
+		mark(spans[1].start, spans[1].size, 0);
+		check_range(&range);
+
+		splay_range_destroy(&range);
+	}
+
+	return 0;
+}
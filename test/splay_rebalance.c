@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+static uint16_t values[256];
+static struct splayitem items[ARRAY_SIZE(values)];
+
+static size_t splayitem_insert_unbalanced(struct splay_root *root,
+					  struct splayitem *new_entry)
+{
+	struct splay_node **cur_nodep = &root->node;
+	struct splay_node *parent = NULL;
+	struct splayitem *cur_entry;
+	size_t depth = 0;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct splayitem, splay);
+
+		parent = *cur_nodep;
+		if (cmpint(&new_entry->i, &cur_entry->i) <= 0)
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+
+		depth++;
+	}
+
+	splay_link_node(&new_entry->splay, parent, cur_nodep);
+
+	return depth;
+}
+
+static size_t check_node_order(struct splay_node *node,
+			       struct splay_node *parent,
+			       const struct splayitem **last, size_t *count)
+{
+	const struct splayitem *item;
+	size_t height_left;
+	size_t height_right;
+
+	if (!node)
+		return 0;
+
+	assert(node->parent == parent);
+
+	height_left = check_node_order(node->left, node, last, count);
+
+	item = splay_entry(node, struct splayitem, splay);
+	if (*last)
+		assert((*last)->i <= item->i);
+	*last = item;
+	(*count)++;
+
+	height_right = check_node_order(node->right, node, last, count);
+
+	if (height_left > height_right)
+		return height_left + 1;
+	else
+		return height_right + 1;
+}
+
+static size_t max_height(size_t count)
+{
+	size_t height = 0;
+
+	while (count) {
+		count >>= 1;
+		height++;
+	}
+
+	return height;
+}
+
+static void check_rebalance(struct splay_root *root, size_t expected)
+{
+	const struct splayitem *last = NULL;
+	size_t count = 0;
+	size_t height;
+
+	assert(splay_rebalance(root) == expected);
+
+	height = check_node_order(root->node, NULL, &last, &count);
+	assert(count == expected);
+	assert(height == max_height(expected));
+}
+
+int main(void)
+{
+	struct splay_balance balance;
+	struct splay_root root;
+	size_t rebalances;
+	size_t depth;
+	size_t i, j;
+
+	INIT_SPLAY_ROOT(&root);
+	check_rebalance(&root, 0);
+
+	for (i = 0; i < 256; i++) {
+		/* sorted input degenerates tree to a list */
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j <= i; j++) {
+			items[j].i = (uint16_t)j;
+			splayitem_insert_unbalanced(&root, &items[j]);
+		}
+		check_rebalance(&root, i + 1);
+
+		/* random input */
+		random_shuffle_array(values, (uint16_t)(i + 1));
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j <= i; j++) {
+			items[j].i = values[j];
+			splayitem_insert_unbalanced(&root, &items[j]);
+		}
+		check_rebalance(&root, i + 1);
+	}
+
+	/* policy limits depth of sorted insertions */
+	INIT_SPLAY_ROOT(&root);
+	INIT_SPLAY_BALANCE(&balance, 2);
+	rebalances = 0;
+	for (j = 0; j < ARRAY_SIZE(items); j++) {
+		items[j].i = (uint16_t)j;
+		depth = splayitem_insert_unbalanced(&root, &items[j]);
+		splay_balance_inc(&balance);
+		assert(splay_depth(&items[j].splay) == depth);
+
+		if (splay_balance_check(&balance, &root, depth)) {
+			assert(balance.count == j + 1);
+			rebalances++;
+		}
+		assert(balance.rebalances == rebalances);
+		assert(depth <= 2 * max_height(j + 1) + 1);
+	}
+	assert(rebalances > 0);
+
+	/* search of last node must be short again after rebalance */
+	splay_rebalance(&root);
+	assert(splay_depth(&items[ARRAY_SIZE(items) - 1].splay) <
+	       max_height(ARRAY_SIZE(items)));
+	assert(!splay_balance_check(&balance, &root,
+				    splay_depth(&items[0].splay)));
+
+	return 0;
+}
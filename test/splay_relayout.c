@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+static uint16_t values[256];
+
+static struct splayitem arena[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+static size_t depths[ARRAY_SIZE(values)];
+static size_t relocated;
+
+static void relocate_item(void *old_entry, void *new_entry, void *priv)
+{
+	struct splayitem *old_item = (struct splayitem *)old_entry;
+	struct splayitem *new_item = (struct splayitem *)new_entry;
+
+	assert(priv == &relocated);
+	assert(old_item->i == new_item->i);
+
+	relocated++;
+	free(old_item);
+}
+
+static size_t arena_index(const struct splay_node *node)
+{
+	return (size_t)(splay_entry(node, struct splayitem, splay) - arena);
+}
+
+int main(void)
+{
+	struct splay_root root;
+	struct splayitem *item;
+	struct splay_node *node;
+	size_t i, j, count;
+
+	INIT_SPLAY_ROOT(&root);
+	count = splay_relayout(&root, arena, ARRAY_SIZE(arena), sizeof(arena[0]),
+			       offsetof(struct splayitem, splay), NULL, NULL);
+	assert(count == 0);
+	assert(splay_empty(&root));
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = (struct splayitem *)malloc(sizeof(*item));
+			assert(item);
+
+			item->i = values[j];
+			splayitem_insert_balanced(&root, item);
+			skiplist[values[j]] = 0;
+		}
+
+		/* arena too small */
+		count = splay_relayout(&root, arena, 3, sizeof(arena[0]),
+				       offsetof(struct splayitem, splay),
+				       relocate_item, &relocated);
+		assert(count == ARRAY_SIZE(values));
+
+		relocated = 0;
+		count = splay_relayout(&root, arena, ARRAY_SIZE(arena),
+				       sizeof(arena[0]),
+				       offsetof(struct splayitem, splay),
+				       relocate_item, &relocated);
+		assert(count == ARRAY_SIZE(values));
+		assert(relocated == ARRAY_SIZE(values));
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		/* entries must be in breadth-first order */
+		assert(root.node == &arena[0].splay);
+		depths[0] = 0;
+		for (j = 1; j < ARRAY_SIZE(arena); j++) {
+			node = arena[j].splay.parent;
+			assert(node);
+			assert(arena_index(node) < j);
+
+			depths[j] = depths[arena_index(node)] + 1;
+			assert(depths[j] >= depths[j - 1]);
+		}
+
+		/* tree must still be usable */
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = splayitem_find(&root, (uint16_t)j);
+			assert(item);
+			splay_splaying(&item->splay, &root);
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+	}
+
+	return 0;
+}
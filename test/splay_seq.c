@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct seqitem {
+	uint16_t value;
+	struct splay_seq_node splay;
+};
+
+static struct seqitem items[256];
+static uint16_t model[ARRAY_SIZE(items)];
+static uint16_t slice_model[ARRAY_SIZE(items)];
+
+static size_t check_node_size(struct splay_seq_node *node,
+			      struct splay_seq_node *parent)
+{
+	size_t size;
+
+	if (!node)
+		return 0;
+
+	assert(node->parent == parent);
+
+	size = 1;
+	size += check_node_size(node->child[SPLAY_DIR_LEFT], node);
+	size += check_node_size(node->child[SPLAY_DIR_RIGHT], node);
+	assert(node->size == size);
+
+	return size;
+}
+
+static void check_root_order(struct splay_seq_root *root,
+			     const uint16_t *expected, size_t count)
+{
+	struct splay_seq_node *node;
+	struct seqitem *item;
+	size_t i;
+
+	assert(check_node_size(root->node, NULL) == count);
+	assert(splay_seq_size(root) == count);
+	assert(splay_seq_empty(root) == (count == 0));
+
+	i = 0;
+	node = splay_seq_first(root);
+	for (; node; node = splay_seq_next(node, root)) {
+		item = splay_entry(node, struct seqitem, splay);
+		assert(i < count);
+		assert(item->value == expected[i]);
+		i++;
+	}
+	assert(i == count);
+
+	node = splay_seq_last(root);
+	for (; node; node = splay_seq_prev(node, root)) {
+		item = splay_entry(node, struct seqitem, splay);
+		assert(i > 0);
+		i--;
+		assert(item->value == expected[i]);
+	}
+	assert(i == 0);
+}
+
+int main(void)
+{
+	struct splay_seq_root slice;
+	struct splay_seq_root root;
+	struct splay_seq_node *node;
+	struct seqitem *item;
+	size_t slice_count;
+	size_t count;
+	size_t index;
+	size_t len;
+	size_t i, j;
+
+	for (i = 0; i < 256; i++) {
+		INIT_SPLAY_SEQ_ROOT(&root);
+		assert(splay_seq_empty(&root));
+		assert(!splay_seq_first(&root));
+		assert(!splay_seq_last(&root));
+		assert(!splay_seq_at(&root, 0));
+		assert(!splay_seq_erase_at(0, &root));
+
+		/* insert at random positions */
+		for (count = 0; count < ARRAY_SIZE(items); count++) {
+			item = &items[count];
+			item->value = (uint16_t)count;
+
+			assert(splay_seq_insert_at(&item->splay, count + 1,
+						   &root) == -1);
+
+			index = getnum() % (count + 1);
+			assert(splay_seq_insert_at(&item->splay, index,
+						   &root) == 0);
+			assert(root.node == &item->splay);
+
+			memmove(&model[index + 1], &model[index],
+				(count - index) * sizeof(model[0]));
+			model[index] = item->value;
+		}
+		check_root_order(&root, model, count);
+
+		/* positional lookup */
+		for (j = 0; j < count; j++) {
+			index = getnum() % count;
+			node = splay_seq_at(&root, index);
+			assert(node);
+			assert(root.node == node);
+			item = splay_entry(node, struct seqitem, splay);
+			assert(item->value == model[index]);
+			assert(splay_seq_index(node, &root) == index);
+		}
+		assert(!splay_seq_at(&root, count));
+		assert(splay_seq_index(&items[model[42]].splay, &root) == 42);
+		check_root_order(&root, model, count);
+
+		/* move random slices around */
+		for (j = 0; j < 64; j++) {
+			index = getnum() % (count + 1);
+			len = getnum() % 32;
+
+			splay_seq_cut(&root, index, len, &slice);
+			slice_count = len;
+			if (index + slice_count > count)
+				slice_count = count - index;
+
+			memcpy(slice_model, &model[index],
+			       slice_count * sizeof(model[0]));
+			memmove(&model[index], &model[index + slice_count],
+				(count - index - slice_count) *
+				sizeof(model[0]));
+			count -= slice_count;
+
+			check_root_order(&root, model, count);
+			check_root_order(&slice, slice_model, slice_count);
+
+			assert(splay_seq_splice(&root, count + 1,
+						&slice) == -1);
+
+			index = getnum() % (count + 1);
+			assert(splay_seq_splice(&root, index, &slice) == 0);
+			assert(splay_seq_empty(&slice));
+
+			memmove(&model[index + slice_count], &model[index],
+				(count - index) * sizeof(model[0]));
+			memcpy(&model[index], slice_model,
+			       slice_count * sizeof(model[0]));
+			count += slice_count;
+
+			check_root_order(&root, model, count);
+		}
+
+		/* split and join back */
+		index = getnum() % (count + 1);
+		splay_seq_split(&root, index, &slice);
+		check_root_order(&root, model, index);
+		check_root_order(&slice, &model[index], count - index);
+		splay_seq_join(&root, &slice);
+		assert(splay_seq_empty(&slice));
+		check_root_order(&root, model, count);
+
+		/* erase by node and by position */
+		while (count) {
+			index = getnum() % count;
+
+			if (count % 2) {
+				node = splay_seq_erase_at(index, &root);
+				assert(node);
+			} else {
+				node = &items[model[index]].splay;
+				splay_seq_erase(node, &root);
+			}
+			item = splay_entry(node, struct seqitem, splay);
+			assert(item->value == model[index]);
+
+			memmove(&model[index], &model[index + 1],
+				(count - index - 1) * sizeof(model[0]));
+			count--;
+
+			check_root_order(&root, model, count);
+		}
+		assert(splay_seq_empty(&root));
+	}
+
+	return 0;
+}
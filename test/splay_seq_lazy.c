@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct lazyitem {
+	int32_t value;
+	int32_t add;
+	int64_t sum;
+	struct splay_seq_node splay;
+};
+
+static struct lazyitem items[256];
+static uint16_t model[ARRAY_SIZE(items)];
+static int32_t model_values[ARRAY_SIZE(items)];
+
+static struct lazyitem *lazyitem_from_node(struct splay_seq_node *node)
+{
+	return splay_entry(node, struct lazyitem, splay);
+}
+
+static void lazyitem_add(struct lazyitem *item, int32_t add)
+{
+	item->value += add;
+	item->add += add;
+	item->sum += (int64_t)add * (int64_t)item->splay.size;
+}
+
+static void lazyitem_push(struct splay_seq_node *node)
+{
+	struct lazyitem *item = lazyitem_from_node(node);
+	size_t i;
+
+	if (!item->add)
+		return;
+
+	for (i = 0; i < 2; i++) {
+		if (!node->child[i])
+			continue;
+
+		lazyitem_add(lazyitem_from_node(node->child[i]), item->add);
+	}
+
+	item->add = 0;
+}
+
+static void lazyitem_update(struct splay_seq_node *node)
+{
+	struct lazyitem *item = lazyitem_from_node(node);
+	size_t i;
+
+	item->sum = item->value;
+	for (i = 0; i < 2; i++) {
+		if (!node->child[i])
+			continue;
+
+		item->sum += lazyitem_from_node(node->child[i])->sum;
+	}
+}
+
+static const struct splay_seq_ops lazyitem_ops = {
+	lazyitem_push,
+	lazyitem_update,
+};
+
+static void lazyitem_apply(struct splay_seq_node *node, void *arg)
+{
+	lazyitem_add(lazyitem_from_node(node), *(const int32_t *)arg);
+}
+
+static void check_root_order(struct splay_seq_root *root, size_t count)
+{
+	struct splay_seq_node *node;
+	struct lazyitem *item;
+	size_t i;
+
+	assert(splay_seq_size(root) == count);
+
+	i = 0;
+	node = splay_seq_first(root);
+	for (; node; node = splay_seq_next(node, root)) {
+		item = lazyitem_from_node(node);
+		assert(i < count);
+		assert(item == &items[model[i]]);
+		assert(item->value == model_values[model[i]]);
+		i++;
+	}
+	assert(i == count);
+
+	node = splay_seq_last(root);
+	for (; node; node = splay_seq_prev(node, root)) {
+		item = lazyitem_from_node(node);
+		assert(i > 0);
+		i--;
+		assert(item == &items[model[i]]);
+	}
+	assert(i == 0);
+}
+
+static void check_range_sum(struct splay_seq_root *root, size_t count)
+{
+	struct splay_seq_root slice;
+	size_t index;
+	size_t len;
+	int64_t sum;
+	size_t i;
+
+	index = getnum() % (count + 1);
+	len = getnum() % 64;
+
+	sum = 0;
+	for (i = index; i < index + len && i < count; i++)
+		sum += model_values[model[i]];
+
+	splay_seq_cut(root, index, len, &slice);
+	if (slice.node)
+		assert(lazyitem_from_node(slice.node)->sum == sum);
+	else
+		assert(sum == 0);
+
+	assert(splay_seq_splice(root, index, &slice) == 0);
+	assert(splay_seq_size(root) == count);
+}
+
+int main(void)
+{
+	struct splay_seq_root root;
+	struct splay_seq_node *node;
+	struct lazyitem *item;
+	size_t index;
+	int32_t add;
+	uint16_t tmp;
+	size_t len;
+	size_t i, j, k;
+
+	for (i = 0; i < 64; i++) {
+		INIT_SPLAY_SEQ_ROOT_OPS(&root, &lazyitem_ops);
+
+		for (j = 0; j < ARRAY_SIZE(items); j++) {
+			item = &items[j];
+			item->value = (int32_t)getnum();
+			item->add = 0;
+			item->sum = item->value;
+			assert(!splay_seq_insert_at(&item->splay, j, &root));
+
+			model[j] = (uint16_t)j;
+			model_values[j] = item->value;
+		}
+		check_root_order(&root, ARRAY_SIZE(items));
+
+		for (j = 0; j < 256; j++) {
+			index = getnum() % (ARRAY_SIZE(items) + 1);
+			len = getnum() % 128;
+
+			if (getnum() % 2) {
+				/* add to all values in range */
+				add = (int32_t)getnum() - 128;
+				splay_seq_apply(&root, index, len,
+						lazyitem_apply, &add);
+
+				for (k = index;
+				     k < index + len && k < ARRAY_SIZE(items);
+				     k++)
+					model_values[model[k]] += add;
+			} else {
+				/* reverse the range */
+				splay_seq_reverse(&root, index, len);
+
+				if (index + len > ARRAY_SIZE(items))
+					len = ARRAY_SIZE(items) - index;
+
+				for (k = 0; k < len / 2; k++) {
+					tmp = model[index + k];
+					model[index + k] =
+						model[index + len - k - 1];
+					model[index + len - k - 1] = tmp;
+				}
+			}
+
+			check_range_sum(&root, ARRAY_SIZE(items));
+
+			/* positional access must see pushed updates */
+			index = getnum() % ARRAY_SIZE(items);
+			node = splay_seq_at(&root, index);
+			assert(node == &items[model[index]].splay);
+			assert(lazyitem_from_node(node)->value ==
+			       model_values[model[index]]);
+			assert(splay_seq_index(&items[model[0]].splay,
+					       &root) == 0);
+		}
+		check_root_order(&root, ARRAY_SIZE(items));
+
+		/* erase by node in reversed tree */
+		for (j = ARRAY_SIZE(items); j > 0; j--) {
+			index = getnum() % j;
+			splay_seq_erase(&items[model[index]].splay, &root);
+
+			for (k = index; k + 1 < j; k++)
+				model[k] = model[k + 1];
+
+			check_range_sum(&root, j - 1);
+		}
+		assert(splay_seq_empty(&root));
+	}
+
+	return 0;
+}
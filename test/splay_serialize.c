@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+static uint16_t values[256];
+
+static struct splayitem items[ARRAY_SIZE(values)];
+static struct splayitem loaded[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+static size_t loaded_count;
+
+static void record_store(void *record, struct splay_node *node, void *priv)
+{
+	struct splayitem *item = splay_entry(node, struct splayitem, splay);
+	unsigned char *buf = (unsigned char *)record;
+
+	assert(priv == &loaded_count);
+
+	buf[0] = (unsigned char)(item->i & 0xff);
+	buf[1] = (unsigned char)(item->i >> 8);
+}
+
+static struct splay_node *record_load(const void *record, void *priv)
+{
+	const unsigned char *buf = (const unsigned char *)record;
+	struct splayitem *item;
+
+	assert(priv == &loaded_count);
+	assert(loaded_count < ARRAY_SIZE(loaded));
+
+	item = &loaded[loaded_count];
+	loaded_count++;
+	item->i = (uint16_t)(buf[0] | (buf[1] << 8));
+
+	return &item->splay;
+}
+
+static void check_same_shape(const struct splay_node *node1,
+			     const struct splay_node *node2)
+{
+	const struct splayitem *item1;
+	const struct splayitem *item2;
+
+	if (!node1 || !node2) {
+		assert(!node1 && !node2);
+		return;
+	}
+
+	item1 = splay_entry(node1, struct splayitem, splay);
+	item2 = splay_entry(node2, struct splayitem, splay);
+	assert(item1->i == item2->i);
+
+	check_same_shape(node1->left, node2->left);
+	check_same_shape(node1->right, node2->right);
+}
+
+static size_t node_depth(const struct splay_node *node)
+{
+	size_t depth_left;
+	size_t depth_right;
+
+	if (!node)
+		return 0;
+
+	depth_left = node_depth(node->left);
+	depth_right = node_depth(node->right);
+
+	if (depth_left > depth_right)
+		return depth_left + 1;
+	else
+		return depth_right + 1;
+}
+
+static void roundtrip(struct splay_root *root, struct splay_root *root2,
+		      unsigned int flags)
+{
+	FILE *fp;
+	int ret;
+
+	fp = tmpfile();
+	assert(fp);
+
+	ret = splay_serialize(root, fp, 2, flags, record_store, &loaded_count);
+	assert(ret == 0);
+
+	rewind(fp);
+	loaded_count = 0;
+	ret = splay_deserialize(root2, fp, 2, record_load, &loaded_count);
+	assert(ret == 0);
+	assert(fgetc(fp) == EOF);
+
+	/* record size mismatch */
+	rewind(fp);
+	ret = splay_deserialize(root2, fp, 3, record_load, &loaded_count);
+	assert(ret == -1);
+	assert(splay_empty(root2));
+
+	rewind(fp);
+	loaded_count = 0;
+	ret = splay_deserialize(root2, fp, 2, record_load, &loaded_count);
+	assert(ret == 0);
+
+	fclose(fp);
+}
+
+int main(void)
+{
+	struct splay_root root;
+	struct splay_root root2;
+	size_t i, j;
+
+	INIT_SPLAY_ROOT(&root);
+	INIT_SPLAY_ROOT(&root2);
+	roundtrip(&root, &root2, 0);
+	assert(splay_empty(&root2));
+	roundtrip(&root, &root2, SPLAY_SERIALIZE_SHAPE);
+	assert(splay_empty(&root2));
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < i + 1; j++) {
+			items[j].i = values[j];
+			if (i % 2)
+				splayitem_insert_balanced(&root, &items[j]);
+			else
+				splayitem_insert_unbalanced(&root, &items[j]);
+			skiplist[values[j]] = 0;
+		}
+
+		/* exact shape */
+		roundtrip(&root, &root2, SPLAY_SERIALIZE_SHAPE);
+		assert(loaded_count == i + 1);
+		check_root_order(&root2, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+		check_same_shape(root.node, root2.node);
+
+		/* balanced */
+		roundtrip(&root, &root2, 0);
+		assert(loaded_count == i + 1);
+		check_root_order(&root2, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+		for (j = 0; (1u << j) <= i + 1; j++)
+			;
+		assert(node_depth(root2.node) == j);
+	}
+
+	return 0;
+}
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splayparallel.h"
+#include "../splaytree.h"
+#include "common.h"
+
+struct setitem {
+	uint16_t value;
+	uint8_t found;
+	struct splay_node splay;
+};
+
+struct pathitem {
+	uint32_t value;
+	struct splay_node splay;
+};
+
+static uint16_t values[256];
+static struct setitem items[2][ARRAY_SIZE(values)];
+static uint8_t member[2][ARRAY_SIZE(values)];
+
+/* deep enough to overflow the stack when recursing along the path */
+#define PATH_NODES (1U << 18)
+#define PATH_STEP 1024
+
+static struct pathitem path_items[PATH_NODES];
+static struct pathitem sparse_items[PATH_NODES / PATH_STEP];
+
+static int cmpnode(const void *key, const struct splay_node *node)
+{
+	const struct setitem *key_item;
+	const struct setitem *item;
+
+	key_item = splay_entry((const struct splay_node *)key,
+			       const struct setitem, splay);
+	item = splay_entry(node, const struct setitem, splay);
+
+	return cmpint(&key_item->value, &item->value);
+}
+
+static void setitem_insert(struct splay_root *root, struct setitem *new_entry)
+{
+	struct splay_node **cur_nodep = &root->node;
+	struct splay_node *parent = NULL;
+	struct setitem *cur_entry;
+
+	while (*cur_nodep) {
+		cur_entry = splay_entry(*cur_nodep, struct setitem, splay);
+
+		parent = *cur_nodep;
+		if (new_entry->value < cur_entry->value)
+			cur_nodep = &((*cur_nodep)->left);
+		else
+			cur_nodep = &((*cur_nodep)->right);
+	}
+
+	splay_insert(&new_entry->splay, parent, cur_nodep, root);
+}
+
+static void check_node_order(struct splay_node *node,
+			     struct splay_node *parent,
+			     const struct setitem **last)
+{
+	struct setitem *item;
+
+	if (!node)
+		return;
+
+	assert(node->parent == parent);
+
+	check_node_order(node->left, node, last);
+
+	item = splay_entry(node, struct setitem, splay);
+	assert(!item->found);
+	item->found = 1;
+
+	/* the remaining nodes can contain one equal node of each tree */
+	if (*last)
+		assert((*last)->value <= item->value);
+	*last = item;
+
+	check_node_order(node->right, node, last);
+}
+
+static int expected_result(enum splay_set_op op, size_t tree, size_t value)
+{
+	switch (op) {
+	case SPLAY_SET_UNION:
+		if (tree == 0)
+			return member[0][value];
+		else
+			return !member[0][value] && member[1][value];
+	case SPLAY_SET_INTERSECTION:
+		return tree == 0 && member[0][value] && member[1][value];
+	case SPLAY_SET_DIFFERENCE:
+		return tree == 0 && member[0][value] && !member[1][value];
+	}
+
+	return 0;
+}
+
+static void check_result(enum splay_set_op op, struct splay_root *root,
+			 struct splay_root *other)
+{
+	const struct setitem *last;
+	size_t t, v;
+
+	for (t = 0; t < 2; t++) {
+		for (v = 0; v < ARRAY_SIZE(values); v++)
+			items[t][v].found = 0;
+	}
+
+	last = NULL;
+	check_node_order(root->node, NULL, &last);
+	for (t = 0; t < 2; t++) {
+		for (v = 0; v < ARRAY_SIZE(values); v++) {
+			assert(items[t][v].found ==
+			       expected_result(op, t, v));
+			items[t][v].found = 0;
+		}
+	}
+
+	/* all other nodes are returned via other */
+	last = NULL;
+	check_node_order(other->node, NULL, &last);
+	for (t = 0; t < 2; t++) {
+		for (v = 0; v < ARRAY_SIZE(values); v++) {
+			assert(items[t][v].found ==
+			       (member[t][v] && !expected_result(op, t, v)));
+		}
+	}
+}
+
+static int cmppath(const void *key, const struct splay_node *node)
+{
+	const struct pathitem *key_item;
+	const struct pathitem *item;
+
+	key_item = splay_entry((const struct splay_node *)key,
+			       const struct pathitem, splay);
+	item = splay_entry(node, const struct pathitem, splay);
+
+	if (key_item->value < item->value)
+		return -1;
+	if (key_item->value > item->value)
+		return 1;
+
+	return 0;
+}
+
+static void path_link(struct splay_root *root, struct pathitem *entries,
+		      size_t count, uint32_t step)
+{
+	struct splay_node *parent = NULL;
+	size_t i;
+
+	/* sorted inserts without splaying degenerate to a right path */
+	INIT_SPLAY_ROOT(root);
+	for (i = 0; i < count; i++) {
+		entries[i].value = (uint32_t)(i * step);
+		entries[i].splay.parent = parent;
+		entries[i].splay.left = NULL;
+		entries[i].splay.right = NULL;
+
+		if (parent)
+			parent->right = &entries[i].splay;
+		else
+			root->node = &entries[i].splay;
+		parent = &entries[i].splay;
+	}
+}
+
+static void check_degenerate_other(unsigned int threads)
+{
+	const struct pathitem *item;
+	struct splay_node *node;
+	struct splay_root root;
+	struct splay_root other;
+	uint32_t expected = 0;
+	size_t count = 0;
+
+	path_link(&root, sparse_items, ARRAY_SIZE(sparse_items), PATH_STEP);
+	path_link(&other, path_items, ARRAY_SIZE(path_items), 1);
+
+	if (threads)
+		assert(!splay_parallel_set_operation(&root, &other,
+						     SPLAY_SET_UNION, cmppath,
+						     threads));
+	else
+		splay_set_operation(&root, &other, SPLAY_SET_UNION, cmppath);
+
+	/* equal keys are kept from root, all others are taken from other */
+	for (node = splay_first(&root); node; node = splay_next(node)) {
+		item = splay_entry(node, struct pathitem, splay);
+		assert(item->value == expected);
+		if (expected % PATH_STEP == 0)
+			assert(item == &sparse_items[expected / PATH_STEP]);
+		else
+			assert(item == &path_items[expected]);
+
+		expected++;
+	}
+	assert(expected == ARRAY_SIZE(path_items));
+
+	for (node = splay_first(&other); node; node = splay_next(node)) {
+		item = splay_entry(node, struct pathitem, splay);
+		assert(item == &path_items[count * PATH_STEP]);
+		count++;
+	}
+	assert(count == ARRAY_SIZE(sparse_items));
+}
+
+int main(void)
+{
+	static const enum splay_set_op ops[] = {
+		SPLAY_SET_UNION,
+		SPLAY_SET_INTERSECTION,
+		SPLAY_SET_DIFFERENCE
+	};
+	struct splay_root roots[2];
+	struct splay_node *equal;
+	struct setitem key;
+	struct splay_root right;
+	size_t i, o, t, v;
+	unsigned int threads;
+	uint8_t density;
+
+	for (i = 0; i < 256; i++) {
+		for (o = 0; o < ARRAY_SIZE(ops); o++) {
+			for (t = 0; t < 2; t++) {
+				INIT_SPLAY_ROOT(&roots[t]);
+				random_shuffle_array(values, ARRAY_SIZE(values));
+
+				/* trees of very different sizes */
+				density = getnum();
+				for (v = 0; v < ARRAY_SIZE(values); v++) {
+					items[t][values[v]].value = values[v];
+					member[t][values[v]] =
+						getnum() <= density;
+					if (!member[t][values[v]])
+						continue;
+
+					setitem_insert(&roots[t],
+						       &items[t][values[v]]);
+				}
+			}
+
+			/* threads are only used by the parallel variant */
+			threads = i % 4 == 0 ? 0 : (unsigned int)(i % 8) + 1;
+			if (threads)
+				assert(!splay_parallel_set_operation(&roots[0],
+								     &roots[1],
+								     ops[o],
+								     cmpnode,
+								     threads));
+			else
+				splay_set_operation(&roots[0], &roots[1],
+						    ops[o], cmpnode);
+			check_result(ops[o], &roots[0], &roots[1]);
+		}
+	}
+
+	check_degenerate_other(0);
+	check_degenerate_other(4);
+
+	/* split and join back */
+	INIT_SPLAY_ROOT(&roots[0]);
+	for (v = 0; v < ARRAY_SIZE(values); v += 2) {
+		items[0][v].value = (uint16_t)v;
+		member[0][v] = 1;
+		member[0][v + 1] = 0;
+		setitem_insert(&roots[0], &items[0][v]);
+	}
+
+	key.value = 100;
+	equal = splay_split(&roots[0], &key.splay, cmpnode, &right);
+	assert(equal == &items[0][100].splay);
+	assert(splay_entry(splay_last(&roots[0]), struct setitem,
+			   splay)->value == 98);
+	assert(splay_entry(splay_first(&right), struct setitem,
+			   splay)->value == 102);
+	splay_join(&roots[0], equal, &right);
+	assert(roots[0].node == equal);
+
+	key.value = 101;
+	assert(!splay_split(&roots[0], &key.splay, cmpnode, &right));
+	assert(splay_entry(splay_last(&roots[0]), struct setitem,
+			   splay)->value == 100);
+	assert(splay_entry(splay_first(&right), struct setitem,
+			   splay)->value == 102);
+	splay_join(&roots[0], NULL, &right);
+	assert(!right.node);
+
+	for (v = 0; v < ARRAY_SIZE(values); v++)
+		member[1][v] = 0;
+	INIT_SPLAY_ROOT(&roots[1]);
+	check_result(SPLAY_SET_UNION, &roots[0], &roots[1]);
+
+	return 0;
+}
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splayparallel.h"
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+
+static struct splayitem items[ARRAY_SIZE(values)];
+static struct splayitem other_items[ARRAY_SIZE(values)];
+static struct splay_u64_node u64_items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static DEFINE_SPLAYROOT(global_root);
+
+static size_t node_depth(const struct splay_node *node)
+{
+	size_t depth = 0;
+
+	while (node->parent) {
+		node = node->parent;
+		depth++;
+	}
+
+	return depth;
+}
+
+static void *iterate_thread(void *arg)
+{
+	struct splay_root *root = (struct splay_root *)arg;
+	struct splay_iter_stats iter_stats;
+	struct splay_node *node;
+
+	/* each thread starts with its own counters */
+	splay_iter_stats_snapshot(&iter_stats);
+	assert(iter_stats.calls == 0);
+
+	for (node = splay_first(root); node; node = splay_next(node))
+		;
+
+	splay_iter_stats_snapshot(&iter_stats);
+	assert(iter_stats.calls == ARRAY_SIZE(values));
+
+	return NULL;
+}
+
+static uint64_t hist_sum(const struct splay_stats *stats)
+{
+	uint64_t sum = 0;
+	size_t i;
+
+	for (i = 0; i < SPLAY_STATS_DEPTH_BUCKETS; i++)
+		sum += stats->depth_hist[i];
+
+	return sum;
+}
+
+static int cmpitem(const void *key, const struct splay_node *node)
+{
+	const struct splayitem *key_item;
+	const struct splayitem *item;
+
+	key_item = splay_entry((const struct splay_node *)key,
+			       const struct splayitem, splay);
+	item = splay_entry(node, const struct splayitem, splay);
+
+	return cmpint(&key_item->i, &item->i);
+}
+
+static void check_set_stats(unsigned int threads)
+{
+	struct splay_stats before[2];
+	struct splay_stats after[2];
+	struct splay_root roots[2];
+	size_t j;
+
+	INIT_SPLAY_ROOT(&roots[0]);
+	INIT_SPLAY_ROOT(&roots[1]);
+	random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+	for (j = 0; j < ARRAY_SIZE(values); j++) {
+		items[j].i = values[j];
+		other_items[j].i = values[j];
+		splayitem_insert_balanced(&roots[0], &items[j]);
+		if (values[j] % 2)
+			splayitem_insert_balanced(&roots[1], &other_items[j]);
+	}
+	splay_stats_snapshot(&roots[0], &before[0]);
+	splay_stats_snapshot(&roots[1], &before[1]);
+
+	if (threads)
+		assert(!splay_parallel_set_operation(&roots[0], &roots[1],
+						     SPLAY_SET_DIFFERENCE,
+						     cmpitem, threads));
+	else
+		splay_set_operation(&roots[0], &roots[1], SPLAY_SET_DIFFERENCE,
+				    cmpitem);
+
+	/* counters of the callers are kept and extended */
+	for (j = 0; j < 2; j++) {
+		splay_stats_snapshot(&roots[j], &after[j]);
+		assert(after[j].splayings >= before[j].splayings);
+		assert(after[j].path_length >= before[j].path_length);
+		assert(after[j].zig + 2 * (after[j].zigzig + after[j].zigzag) ==
+		       after[j].path_length);
+		assert(hist_sum(&after[j]) == after[j].splayings);
+	}
+
+	/* each split of the first tree splays it once */
+	assert(after[0].splayings >=
+	       before[0].splayings + ARRAY_SIZE(values) / 2);
+}
+
+static void check_dir_stats(void)
+{
+	struct splay_u64_root root;
+	struct splay_stats stats;
+	uint64_t erased;
+	size_t j;
+
+	INIT_SPLAY_U64_ROOT(&root);
+	splay_dir_stats_snapshot(&root.dir, &stats);
+	assert(stats.splayings == 0);
+
+	random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+	for (j = 0; j < ARRAY_SIZE(values); j++) {
+		u64_items[j].key = values[j];
+		splay_u64_insert(&u64_items[j], &root);
+	}
+
+	splay_dir_stats_snapshot(&root.dir, &stats);
+	assert(stats.splayings == ARRAY_SIZE(values));
+	assert(stats.zig + 2 * (stats.zigzig + stats.zigzag) ==
+	       stats.path_length);
+	assert(hist_sum(&stats) == ARRAY_SIZE(values));
+	assert(stats.depth_hist[0] == 1);
+
+	splay_dir_stats_reset(&root.dir);
+	for (j = 0; j < ARRAY_SIZE(values); j++)
+		splay_u64_erase(&u64_items[j], &root);
+	assert(splay_u64_empty(&root));
+
+	splay_dir_stats_snapshot(&root.dir, &stats);
+	erased = stats.erase_leaf + stats.erase_one_child +
+		 stats.erase_two_children;
+	assert(erased == ARRAY_SIZE(values));
+}
+
+int main(void)
+{
+	struct splay_iter_stats iter_stats;
+	struct splay_stats stats;
+	struct splay_root root;
+	struct splay_node *node;
+	struct splayitem *item;
+	uint64_t path_length;
+	uint64_t erased;
+	size_t i, j, depth;
+
+	splay_stats_snapshot(&global_root, &stats);
+	assert(stats.splayings == 0);
+	assert(hist_sum(&stats) == 0);
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+		path_length = 0;
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			items[j].i = values[j];
+			splayitem_insert_unbalanced(&root, &items[j]);
+			skiplist[values[j]] = 0;
+
+			depth = node_depth(&items[j].splay);
+			path_length += depth;
+			splay_splaying(&items[j].splay, &root);
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		splay_stats_snapshot(&root, &stats);
+		assert(stats.splayings == ARRAY_SIZE(values));
+		assert(stats.path_length == path_length);
+		assert(stats.zig + 2 * (stats.zigzig + stats.zigzag) ==
+		       path_length);
+		assert(hist_sum(&stats) == ARRAY_SIZE(values));
+		assert(stats.depth_hist[0] == 1);
+		assert(stats.erase_leaf == 0);
+		assert(stats.erase_one_child == 0);
+		assert(stats.erase_two_children == 0);
+
+		/* full iteration follows each link at most twice */
+		splay_iter_stats_reset();
+		for (node = splay_first(&root), j = 0; node;
+		     node = splay_next(node), j++)
+			;
+		assert(j == ARRAY_SIZE(values));
+		splay_iter_stats_snapshot(&iter_stats);
+		assert(iter_stats.calls == ARRAY_SIZE(values));
+		assert(iter_stats.hops >= ARRAY_SIZE(values) - 1);
+		assert(iter_stats.hops <= 2 * ARRAY_SIZE(values));
+
+		/* iterations in other threads are not accounted here */
+		if (i == 0) {
+			pthread_t thread;
+
+			assert(!pthread_create(&thread, NULL, iterate_thread,
+					       &root));
+			assert(!pthread_join(thread, NULL));
+
+			splay_iter_stats_snapshot(&iter_stats);
+			assert(iter_stats.calls == ARRAY_SIZE(values));
+		}
+
+		splay_stats_reset(&root);
+		splay_stats_snapshot(&root, &stats);
+		assert(stats.splayings == 0);
+		assert(stats.zig == 0);
+		assert(hist_sum(&stats) == 0);
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = splayitem_find(&root, delete_items[j]);
+			assert(item);
+
+			splay_erase(&item->splay, &root);
+			skiplist[item->i] = 1;
+		}
+		assert(splay_empty(&root));
+
+		splay_stats_snapshot(&root, &stats);
+		erased = stats.erase_leaf + stats.erase_one_child +
+			 stats.erase_two_children;
+		assert(erased == ARRAY_SIZE(values));
+		assert(stats.splayings < ARRAY_SIZE(values));
+	}
+
+	check_set_stats(0);
+	check_set_stats(4);
+	check_dir_stats();
+
+	return 0;
+}
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct stritem {
+	char buf[32];
+	uint16_t rank;
+	struct splay_str_node splay;
+};
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static struct stritem items[ARRAY_SIZE(values)];
+
+/* keys with equal prefixes, embedded zeros and all lengths around 8 bytes */
+static size_t build_key(char *buf, size_t size, uint16_t v)
+{
+	int len;
+
+	switch (v % 4) {
+	case 0:
+		len = snprintf(buf, size, "%u", v);
+		break;
+	case 1:
+		len = snprintf(buf, size, "/usr/share/%u", v);
+		break;
+	case 2:
+		len = snprintf(buf, size, "/usr/sh%c%u", '\0', v);
+		break;
+	default:
+		len = snprintf(buf, size, "%.*s", (int)(v % 13),
+			       "/usr/share/xyz");
+		len += snprintf(buf + len, size - (size_t)len, "%c%u", '\0', v);
+		break;
+	}
+	assert(len > 0 && (size_t)len < size);
+
+	return (size_t)len;
+}
+
+static int cmpkey(const void *a, size_t alen, const void *b, size_t blen)
+{
+	size_t common = alen < blen ? alen : blen;
+	int res;
+
+	res = memcmp(a, b, common);
+	if (res)
+		return res;
+
+	if (alen == blen)
+		return 0;
+
+	return alen < blen ? -1 : 1;
+}
+
+static void calc_ranks(void)
+{
+	size_t i, j;
+	uint16_t rank;
+
+	for (i = 0; i < ARRAY_SIZE(items); i++) {
+		rank = 0;
+		for (j = 0; j < ARRAY_SIZE(items); j++) {
+			if (cmpkey(items[j].splay.key, items[j].splay.len,
+				   items[i].splay.key, items[i].splay.len) < 0)
+				rank++;
+		}
+		items[i].rank = rank;
+	}
+}
+
+static void check_node_order(struct splay_dir_node *node,
+			     struct splay_dir_node *parent,
+			     uint16_t *pos)
+{
+	struct stritem *item;
+
+	if (!node)
+		return;
+
+	assert(splay_dir_parent(node) == parent);
+
+	check_node_order(node->child[SPLAY_DIR_LEFT], node, pos);
+
+	while (*pos < ARRAY_SIZE(skiplist) && skiplist[*pos])
+		(*pos)++;
+	assert(*pos < ARRAY_SIZE(skiplist));
+
+	item = splay_entry(splay_str_from_dir(node), struct stritem, splay);
+	assert(item->rank == *pos);
+	(*pos)++;
+
+	check_node_order(node->child[SPLAY_DIR_RIGHT], node, pos);
+}
+
+static void check_root_order(struct splay_str_root *root)
+{
+	struct splay_str_node *node;
+	struct stritem *item;
+	uint16_t pos = 0;
+	int last = -1;
+
+	check_node_order(root->dir.node, NULL, &pos);
+	while (pos < ARRAY_SIZE(skiplist) && skiplist[pos])
+		pos++;
+	assert(pos == ARRAY_SIZE(skiplist));
+
+	for (node = splay_str_first(root); node; node = splay_str_next(node)) {
+		item = splay_entry(node, struct stritem, splay);
+		assert(last < item->rank);
+		last = item->rank;
+	}
+
+	last = ARRAY_SIZE(values);
+	for (node = splay_str_last(root); node; node = splay_str_prev(node)) {
+		item = splay_entry(node, struct stritem, splay);
+		assert(last > item->rank);
+		last = item->rank;
+	}
+}
+
+int main(void)
+{
+	struct splay_str_root root;
+	struct splay_str_node *node;
+	struct stritem *item;
+	char probe[33];
+	size_t i, j;
+	size_t len;
+
+	for (i = 0; i < ARRAY_SIZE(items); i++) {
+		len = build_key(items[i].buf, sizeof(items[i].buf),
+				(uint16_t)i);
+		splay_str_node_init(&items[i].splay, items[i].buf, len);
+	}
+	calc_ranks();
+
+	/* prefix compares like the first 8 bytes */
+	assert(splay_str_prefix("", 0) == 0);
+	assert(splay_str_prefix("a", 1) == UINT64_C(0x6100000000000000));
+	assert(splay_str_prefix("abcdefghij", 10) ==
+	       UINT64_C(0x6162636465666768));
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+
+		INIT_SPLAY_STR_ROOT(&root);
+		assert(splay_str_empty(&root));
+		assert(!splay_str_first(&root));
+		assert(!splay_str_last(&root));
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[values[j]];
+			splay_str_insert(&item->splay, &root);
+			skiplist[item->rank] = 0;
+
+			assert(root.dir.node == &item->splay.dir);
+		}
+		check_root_order(&root);
+
+		for (j = 0; j < ARRAY_SIZE(items); j++) {
+			item = &items[j];
+
+			node = splay_str_find(&root, item->splay.key,
+					      item->splay.len);
+			assert(node == &item->splay);
+			assert(root.dir.node == &item->splay.dir);
+
+			/* key with appended byte is between item and next */
+			memcpy(probe, item->buf, item->splay.len);
+			probe[item->splay.len] = '\0';
+			assert(!splay_str_find(&root, probe,
+					       item->splay.len + 1));
+
+			node = splay_str_lower_bound(&root, probe,
+						     item->splay.len + 1);
+			if (item->rank == ARRAY_SIZE(items) - 1) {
+				assert(!node);
+			} else {
+				assert(node);
+				item = splay_entry(node, struct stritem, splay);
+				assert(item->rank == items[j].rank + 1);
+			}
+		}
+		check_root_order(&root);
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = &items[delete_items[j]];
+
+			splay_str_erase(&item->splay, &root);
+			skiplist[item->rank] = 1;
+
+			check_root_order(&root);
+		}
+		assert(splay_str_empty(&root));
+	}
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaytimer.h"
+#include "../splaytree.h"
+#include "common.h"
+
+struct timeritem {
+	uint16_t i;
+	uint16_t seq;
+	uint8_t rearmed;
+	uint8_t fired;
+	struct splay_timer timer;
+};
+
+static uint16_t values[256];
+static uint16_t cancel_items[ARRAY_SIZE(values)];
+static struct timeritem items[ARRAY_SIZE(values)];
+
+static struct splay_timer_queue queue;
+static struct timeritem *last_fired;
+static size_t fired;
+
+static void timeritem_fire(struct splay_timer *timer)
+{
+	struct timeritem *item;
+
+	item = splay_entry(timer, struct timeritem, timer);
+	assert(!splay_timer_pending(timer));
+	assert(item->fired < 2);
+
+	/* deadline order, arm order for equal deadlines */
+	if (last_fired) {
+		assert(last_fired->timer.expires <= timer->expires);
+		if (last_fired->timer.expires == timer->expires &&
+		    !last_fired->rearmed && !item->rearmed)
+			assert(last_fired->seq < item->seq);
+	}
+
+	last_fired = item;
+	item->fired++;
+	fired++;
+
+	/* cancel the partner timer which may expire in the same batch */
+	if (item->i % 8 == 0)
+		splay_timer_cancel(&queue, &items[item->i + 1].timer);
+
+	/* re-arm with already expired deadline */
+	if (item->i % 8 == 2 && item->fired == 1) {
+		item->rearmed = 1;
+		splay_timer_arm(&queue, timer, 0);
+	}
+}
+
+static void check_queue(void)
+{
+	struct splay_timer *timer;
+	struct splay_node *node;
+	size_t count = 0;
+	size_t j;
+
+	timer = NULL;
+	for (node = splay_first(&queue.armed); node; node = splay_next(node)) {
+		if (!timer)
+			assert(queue.first ==
+			       splay_entry(node, struct splay_timer, node));
+		else
+			assert(timer->expires <=
+			       splay_entry(node, struct splay_timer,
+					   node)->expires);
+
+		timer = splay_entry(node, struct splay_timer, node);
+		assert(splay_timer_pending(timer));
+		count++;
+	}
+	if (!timer)
+		assert(!queue.first);
+	assert(count == queue.count);
+
+	count = 0;
+	for (j = 0; j < ARRAY_SIZE(items); j++) {
+		if (splay_timer_pending(&items[j].timer))
+			count++;
+	}
+	assert(count == queue.count);
+}
+
+int main(void)
+{
+	struct timeritem *item;
+	uint64_t expires;
+	size_t pending;
+	size_t i, j;
+	size_t n;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		random_shuffle_array(cancel_items,
+				     (uint16_t)ARRAY_SIZE(cancel_items));
+		memset(items, 0, sizeof(items));
+
+		splay_timer_queue_init(&queue);
+		assert(!splay_timer_first(&queue));
+		assert(splay_timer_expire(&queue, UINT64_MAX) == 0);
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[values[j]];
+			item->i = values[j];
+			item->seq = (uint16_t)j;
+			splay_timer_init(&item->timer, timeritem_fire);
+
+			/* every deadline is used twice */
+			splay_timer_arm(&queue, &item->timer, item->i / 2 + 1);
+			assert(splay_timer_pending(&item->timer));
+		}
+		check_queue();
+
+		/* re-arm in place and with moving */
+		for (j = 0; j < ARRAY_SIZE(values) / 4; j++) {
+			item = &items[cancel_items[j]];
+			expires = item->timer.expires;
+			if (j % 2)
+				expires += 64;
+
+			/* re-armed timers are queued behind equal deadlines */
+			splay_timer_arm(&queue, &item->timer, expires);
+			item->seq = (uint16_t)(ARRAY_SIZE(values) + j);
+			assert(splay_timer_pending(&item->timer));
+		}
+		check_queue();
+
+		/* cancel some timers */
+		for (j = ARRAY_SIZE(values) / 4; j < ARRAY_SIZE(values) / 2;
+		     j++) {
+			item = &items[cancel_items[j]];
+			assert(splay_timer_cancel(&queue, &item->timer) == 1);
+			assert(splay_timer_cancel(&queue, &item->timer) == 0);
+			assert(!splay_timer_pending(&item->timer));
+		}
+		check_queue();
+
+		/* expire in batches */
+		last_fired = NULL;
+		fired = 0;
+		for (n = 0; n < 256; n += 16) {
+			pending = queue.count;
+			j = splay_timer_expire(&queue, n);
+			assert(j == fired);
+			fired = 0;
+			last_fired = NULL;
+
+			/* only timers re-armed by callbacks may be expired */
+			assert(!queue.first || queue.first->expires > n ||
+			       queue.first->expires == 0);
+			check_queue();
+			assert(queue.count <= pending);
+		}
+
+		j = splay_timer_expire(&queue, UINT64_MAX);
+		assert(j == fired);
+		assert(queue.count == 0);
+		assert(!queue.first);
+		assert(splay_empty(&queue.armed));
+		assert(splay_empty(&queue.expired));
+	}
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../splaytree.h"
+#include "common.h"
+#include "common-treeops.h"
+#include "common-treevalidation.h"
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+
+static struct splayitem items[ARRAY_SIZE(values)];
+static uint8_t skiplist[ARRAY_SIZE(values)];
+
+static size_t events[SPLAY_TRACE_INSERT_EXIT + 1];
+static const struct splay_node *last_node;
+static size_t last_depth;
+static size_t expected_depth;
+
+static void trace_hook(enum splay_trace_event event,
+		       const struct splay_node *node, size_t depth,
+		       size_t rotations)
+{
+	events[event]++;
+
+	switch (event) {
+	case SPLAY_TRACE_SPLAYING_ENTRY:
+	case SPLAY_TRACE_ERASE_ENTRY:
+	case SPLAY_TRACE_INSERT_ENTRY:
+		assert(depth == 0);
+		assert(rotations == 0);
+		last_node = node;
+		break;
+	case SPLAY_TRACE_SPLAYING_EXIT:
+		assert(node == last_node);
+		assert(depth == rotations);
+		last_depth = depth;
+		break;
+	case SPLAY_TRACE_ERASE_EXIT:
+		assert(node == last_node);
+		assert(rotations == 0);
+		break;
+	case SPLAY_TRACE_INSERT_EXIT:
+		assert(node->parent == NULL);
+		break;
+	}
+}
+
+static size_t node_depth(const struct splay_node *node)
+{
+	size_t depth = 0;
+
+	while (node->parent) {
+		node = node->parent;
+		depth++;
+	}
+
+	return depth;
+}
+
+int main(void)
+{
+	struct splay_root root;
+	struct splayitem *item;
+	size_t i, j;
+
+	splay_trace_set_hook(trace_hook);
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+		memset(skiplist, 1, sizeof(skiplist));
+		memset(events, 0, sizeof(events));
+
+		INIT_SPLAY_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			items[j].i = values[j];
+			splayitem_insert_unbalanced(&root, &items[j]);
+			skiplist[values[j]] = 0;
+
+			expected_depth = node_depth(&items[j].splay);
+			splay_splaying(&items[j].splay, &root);
+			assert(last_depth == expected_depth);
+		}
+		check_root_order(&root, skiplist,
+				 (uint16_t)ARRAY_SIZE(skiplist));
+
+		assert(events[SPLAY_TRACE_SPLAYING_ENTRY] == ARRAY_SIZE(values));
+		assert(events[SPLAY_TRACE_SPLAYING_EXIT] == ARRAY_SIZE(values));
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = splayitem_find(&root, delete_items[j]);
+			assert(item);
+
+			splay_erase(&item->splay, &root);
+			skiplist[item->i] = 1;
+		}
+		assert(splay_empty(&root));
+		assert(events[SPLAY_TRACE_ERASE_ENTRY] == ARRAY_SIZE(values));
+		assert(events[SPLAY_TRACE_ERASE_EXIT] == ARRAY_SIZE(values));
+
+		/* splay_insert adds its own trace points */
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			items[j].i = values[j];
+			splay_insert(&items[j].splay, NULL, &root.node, &root);
+			INIT_SPLAY_ROOT(&root);
+		}
+		assert(events[SPLAY_TRACE_INSERT_ENTRY] == ARRAY_SIZE(values));
+		assert(events[SPLAY_TRACE_INSERT_EXIT] == ARRAY_SIZE(values));
+	}
+
+	splay_trace_set_hook(NULL);
+	INIT_SPLAY_ROOT(&root);
+	splayitem_insert_balanced(&root, &items[0]);
+
+	return 0;
+}
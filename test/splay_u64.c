@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+struct u64item {
+	uint16_t seq;
+	uint8_t linked;
+	struct splay_u64_node splay;
+};
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+
+static struct u64item items[ARRAY_SIZE(values)];
+
+static void check_node_order(struct splay_dir_node *node,
+			     struct splay_dir_node *parent,
+			     const struct u64item **last, size_t *count)
+{
+	const struct u64item *item;
+
+	if (!node)
+		return;
+
+	assert(splay_dir_parent(node) == parent);
+
+	check_node_order(node->child[SPLAY_DIR_LEFT], node, last, count);
+
+	item = splay_entry(splay_u64_from_dir(node), struct u64item, splay);
+	assert(item->linked);
+	if (*last) {
+		/* equal keys are sorted by insertion order */
+		assert((*last)->splay.key <= item->splay.key);
+		if ((*last)->splay.key == item->splay.key)
+			assert((*last)->seq < item->seq);
+	}
+	*last = item;
+	(*count)++;
+
+	check_node_order(node->child[SPLAY_DIR_RIGHT], node, last, count);
+}
+
+static void check_root_order(struct splay_u64_root *root, size_t expected)
+{
+	const struct u64item *last = NULL;
+	struct splay_u64_node *node;
+	size_t count = 0;
+	uint64_t prev;
+
+	check_node_order(root->dir.node, NULL, &last, &count);
+	assert(count == expected);
+
+	count = 0;
+	prev = 0;
+	for (node = splay_u64_first(root); node; node = splay_u64_next(node)) {
+		assert(prev <= node->key);
+		prev = node->key;
+		count++;
+	}
+	assert(count == expected);
+
+	count = 0;
+	prev = UINT64_MAX;
+	for (node = splay_u64_last(root); node; node = splay_u64_prev(node)) {
+		assert(prev >= node->key);
+		prev = node->key;
+		count++;
+	}
+	assert(count == expected);
+}
+
+int main(void)
+{
+	struct splay_u64_root root;
+	struct splay_u64_node *node;
+	struct splay_u64_node *prev;
+	struct u64item *item;
+	size_t i, j;
+	uint64_t k;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+
+		INIT_SPLAY_U64_ROOT(&root);
+		assert(splay_u64_empty(&root));
+		assert(!splay_u64_first(&root));
+		assert(!splay_u64_last(&root));
+		assert(!splay_u64_lower_bound(&root, 0));
+
+		/* only even keys, each of them twice */
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[j];
+			item->seq = (uint16_t)j;
+			item->linked = 1;
+			item->splay.key = (values[j] / 2) * 2;
+			splay_u64_insert(&item->splay, &root);
+
+			assert(root.dir.node == &item->splay.dir);
+		}
+		check_root_order(&root, ARRAY_SIZE(values));
+
+		for (k = 0; k < ARRAY_SIZE(values) - 1; k++) {
+			node = splay_u64_lower_bound(&root, k);
+			assert(node);
+			assert(node->key == ((k + 1) / 2) * 2);
+			assert(root.dir.node == &node->dir);
+
+			/* always the first of the equal keys */
+			prev = splay_u64_prev(node);
+			assert(!prev || prev->key < node->key);
+
+			assert(splay_u64_count(&root, k) == (k % 2 ? 0 : 2));
+
+			node = splay_u64_find(&root, k);
+			if (k % 2) {
+				assert(!node);
+			} else {
+				assert(node);
+				assert(node->key == k);
+				assert(root.dir.node == &node->dir);
+			}
+		}
+		assert(!splay_u64_lower_bound(&root, ARRAY_SIZE(values) - 1));
+		assert(!splay_u64_find(&root, UINT64_MAX));
+		check_root_order(&root, ARRAY_SIZE(values));
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = &items[delete_items[j]];
+
+			splay_u64_erase(&item->splay, &root);
+			item->linked = 0;
+
+			check_root_order(&root, ARRAY_SIZE(values) - j - 1);
+		}
+		assert(splay_u64_empty(&root));
+	}
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MIT
+/* Minimal Splay-tree helper functions test
+ *
+ * SPDX-FileCopyrightText: Sven Eckelmann <sven@narfation.org>
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../splaytree.h"
+#include "common.h"
+
+#define DUPLICATES 8
+
+struct multiitem {
+	uint16_t seq;
+	uint8_t linked;
+	struct splay_u64_multi_node splay;
+};
+
+static uint16_t values[256];
+static uint16_t delete_items[ARRAY_SIZE(values)];
+static size_t counts[ARRAY_SIZE(values) / DUPLICATES];
+
+static struct multiitem items[ARRAY_SIZE(values)];
+
+static size_t check_node_order(struct splay_dir_node *node,
+			       struct splay_dir_node *parent)
+{
+	struct splay_u64_multi_node *entry;
+	size_t count = 1;
+
+	if (!node)
+		return 0;
+
+	assert(splay_dir_parent(node) == parent);
+	entry = splay_u64_multi_from_u64(splay_u64_from_dir(node));
+	assert(entry->head);
+
+	count += check_node_order(node->child[SPLAY_DIR_LEFT], node);
+	count += check_node_order(node->child[SPLAY_DIR_RIGHT], node);
+
+	return count;
+}
+
+static void check_root_order(struct splay_u64_root *root)
+{
+	struct splay_u64_multi_node *entry;
+	struct splay_u64_node *node;
+	struct multiitem *item;
+	size_t distinct = 0;
+	size_t count;
+	uint64_t k;
+	int last;
+
+	for (k = 0; k < ARRAY_SIZE(counts); k++) {
+		if (counts[k])
+			distinct++;
+	}
+
+	/* only one node per distinct key in the tree */
+	assert(check_node_order(root->dir.node, NULL) == distinct);
+
+	last = -1;
+	for (node = splay_u64_first(root); node; node = splay_u64_next(node)) {
+		assert(last < (int)node->key);
+		last = (int)node->key;
+	}
+
+	for (k = 0; k < ARRAY_SIZE(counts); k++) {
+		assert(splay_u64_multi_count(root, k) == counts[k]);
+
+		entry = splay_u64_multi_find(root, k);
+		if (!counts[k]) {
+			assert(!entry);
+			continue;
+		}
+
+		/* duplicates are kept in insertion order */
+		count = 0;
+		last = -1;
+		for (; entry; entry = splay_u64_multi_dup_next(entry)) {
+			item = splay_entry(entry, struct multiitem, splay);
+			assert(item->linked);
+			assert(entry->tree.key == k);
+			assert(last < item->seq);
+			last = item->seq;
+			count++;
+		}
+		assert(count == counts[k]);
+	}
+}
+
+int main(void)
+{
+	struct splay_u64_root root;
+	struct multiitem *item;
+	size_t i, j;
+
+	for (i = 0; i < 256; i++) {
+		random_shuffle_array(values, (uint16_t)ARRAY_SIZE(values));
+
+		INIT_SPLAY_U64_ROOT(&root);
+		for (j = 0; j < ARRAY_SIZE(counts); j++)
+			counts[j] = 0;
+
+		for (j = 0; j < ARRAY_SIZE(values); j++) {
+			item = &items[j];
+			item->seq = (uint16_t)j;
+			item->linked = 1;
+			item->splay.tree.key = values[j] / DUPLICATES;
+			splay_u64_multi_insert(&item->splay, &root);
+			counts[values[j] / DUPLICATES]++;
+
+			assert(splay_u64_from_dir(root.dir.node)->key ==
+			       item->splay.tree.key);
+		}
+		check_root_order(&root);
+
+		random_shuffle_array(delete_items,
+				     (uint16_t)ARRAY_SIZE(delete_items));
+		for (j = 0; j < ARRAY_SIZE(delete_items); j++) {
+			item = &items[delete_items[j]];
+
+			splay_u64_multi_erase(&item->splay, &root);
+			item->linked = 0;
+			counts[item->splay.tree.key]--;
+
+			check_root_order(&root);
+		}
+		assert(splay_u64_empty(&root));
+	}
+
+	return 0;
+}